@@ -79,6 +79,13 @@ namespace mpi {
       return c;
     }
 
+    /// The communicator of the nodes which can share memory with this one (typically, the same compute node)
+    communicator split_shared(int key = 0) const {
+      communicator c;
+      MPI_Comm_split_type(_com, MPI_COMM_TYPE_SHARED, key, MPI_INFO_NULL, &c._com);
+      return c;
+    }
+
 #ifdef BOOST_MPI_HPP
     // Conversion to and from boost communicator, Keep for backward compatibility
     inline operator boost::mpi::communicator() const { return boost::mpi::communicator(_com, boost::mpi::comm_duplicate); }
@@ -133,6 +140,9 @@ namespace mpi {
   template <typename T>[[gnu::always_inline]] inline decltype(auto) gather(T &&x, mpi::communicator c = {}, int root = 0, bool all = false) {
     return mpi_gather(std::forward<T>(x), c, root, all);
   }
+  template <typename T>[[gnu::always_inline]] inline decltype(auto) broadcast_shared(T &&x, communicator c = {}, int root = 0) {
+    return mpi_broadcast_shared(std::forward<T>(x), c, root);
+  }
   template <typename T>[[gnu::always_inline]] inline decltype(auto) all_reduce(T &&x, communicator c = {}, int root = 0, MPI_Op op = MPI_SUM) {
     return reduce(std::forward<T>(x), c, root, true, op);
   }
@@ -0,0 +1,150 @@
+/*******************************************************************************
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+#include "./vector.hpp"
+#include <memory>
+
+namespace mpi {
+
+  /* -----------------------------------------------------------
+  *  Non-blocking collectives
+  *
+  *  ireduce, iall_reduce and ibroadcast start the communication and return at once a future,
+  *  which owns a copy of the object and the communication buffers.
+  *  The result is obtained with get(), which waits for the completion of the communication.
+  *
+  *  The object must be an MPI type, or expose its numbers with mpi_foreach_payload (cf vector.hpp) :
+  *  e.g. arrays, gf, block_gf, and vectors of them.
+  *  As for all collectives, all nodes must start the same operations in the same order.
+  * ---------------------------------------------------------- */
+
+  template <typename T> class future {
+
+    struct state_t {
+      T x;
+      detail::packed_buffer buf;         // the packed numbers of x, if it is not an MPI type
+      std::vector<MPI_Request> requests; // one per chunk of the buffers
+      bool unpack = false;               // on completion, copy buf back into x
+    };
+    std::unique_ptr<state_t> _s; // on the heap : the buffers do not move with the future
+
+    public:
+    /**
+     * Start a communication on a copy of x : op(p, count, mpi_type, request) is called on each chunk of the data.
+     * With split_complex, the complex numbers are communicated with the complex MPI type (cf detail::packed_buffer).
+     */
+    template <typename Op> future(T x, bool receives, Op op, bool split_complex = false) : _s{new state_t{std::move(x), {split_complex}, {}, false}} {
+      if constexpr (has_mpi_type<T>) {
+        _s->requests.resize(1);
+        op(&_s->x, 1, mpi_type<T>::get(), &_s->requests[0]);
+      } else {
+        static_assert(has_mpi_payload<T>, "mpi non-blocking collective : the object has no mpi type, nor mpi_foreach_payload");
+        _s->buf.pack(_s->x);
+        _s->requests.resize(_s->buf.n_chunks());
+        long k = 0;
+        _s->buf.foreach_chunk([&](void *p, int count, MPI_Datatype t) { op(p, count, t, &_s->requests[k++]); });
+        _s->unpack = receives;
+      }
+    }
+
+    future(future &&)  = default;
+    future &operator=(future &&x) {
+      wait();
+      _s = std::move(x._s);
+      return *this;
+    }
+
+    /// MPI must complete the communication before the buffers are released
+    ~future() { wait(); }
+
+    /// Is the communication completed ? Does not block.
+    bool ready() {
+      if (!_s or _s->requests.empty()) return true;
+      int flag = 0;
+      MPI_Testall(_s->requests.size(), _s->requests.data(), &flag, MPI_STATUSES_IGNORE);
+      if (flag) finish();
+      return flag;
+    }
+
+    /// Wait for the completion of the communication
+    void wait() {
+      if (!_s or _s->requests.empty()) return;
+      MPI_Waitall(_s->requests.size(), _s->requests.data(), MPI_STATUSES_IGNORE);
+      finish();
+    }
+
+    /// The result, after completion. As for the blocking reduce, it is valid only on the nodes receiving it.
+    T &get() & {
+      wait();
+      return _s->x;
+    }
+
+    /// The result, after completion.
+    T get() && {
+      wait();
+      return std::move(_s->x);
+    }
+
+    private:
+    void finish() {
+      _s->requests.clear();
+      if (!_s->unpack) return;
+      if constexpr (!has_mpi_type<T>) _s->buf.unpack(_s->x);
+      _s->buf = {};
+    }
+  };
+
+  // ---------------- reduce ---------------------
+
+  /**
+   * Start the reduction of x over the communicator c.
+   *
+   * @return A future owning a copy of x. Once completed, it contains the reduced object on root (on all nodes if all)
+   */
+  template <typename T> future<regular_t<T>> ireduce(T const &x, communicator c = {}, int root = 0, bool all = false, MPI_Op op = MPI_SUM) {
+    bool receives = all or (c.rank() == root);
+    return {detail::make_regular_copy(x), receives, [c, root, all, op](void *p, int count, MPI_Datatype d, MPI_Request *r) mutable {
+              if (!all)
+                MPI_Ireduce((c.rank() == root ? MPI_IN_PLACE : p), p, count, d, op, root, c.get(), r);
+              else
+                MPI_Iallreduce(MPI_IN_PLACE, p, count, d, op, c.get(), r);
+            },
+            op != MPI_SUM};
+  }
+
+  template <typename T> future<regular_t<T>> iall_reduce(T const &x, communicator c = {}, int root = 0, MPI_Op op = MPI_SUM) {
+    return ireduce(x, c, root, true, op);
+  }
+
+  // ---------------- broadcast ---------------------
+
+  /**
+   * Start the broadcast of x from root.
+   *
+   * On the other nodes, x must have the same structure (sizes of the arrays, number of blocks...) as on root :
+   * only its numbers are replaced.
+   *
+   * @return A future owning a copy of x. Once completed, it contains the object of the root on all nodes.
+   */
+  template <typename T> future<regular_t<T>> ibroadcast(T const &x, communicator c = {}, int root = 0) {
+    return {detail::make_regular_copy(x), c.rank() != root,
+            [c, root](void *p, int count, MPI_Datatype d, MPI_Request *r) mutable { MPI_Ibcast(p, count, d, root, c.get(), r); }};
+  }
+
+} // namespace mpi
@@ -19,6 +19,8 @@
 
 #pragma once
 #include "./mpi.hpp"
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace mpi {
@@ -35,6 +37,139 @@ namespace mpi {
       for (auto &x : v) broadcast(x, c, root);
     }
   }
+  // ---------------- packed payload ---------------------
+
+  // Objects made of many arrays of numbers (e.g. a vector of Green functions) are reduced with a single collective
+  // on a buffer into which their numbers are packed.
+  // The numbers of an object x are exposed by mpi_foreach_payload(x, f), found by ADL, which calls f(p, n)
+  // on each of its contiguous chunks of n elements starting at p.
+  // The elements must be double or std::complex<double>, and the chunks the same on all nodes.
+
+  template <typename T> constexpr bool is_packable_scalar = std::is_same_v<T, double> or std::is_same_v<T, std::complex<double>>;
+
+  namespace detail {
+    struct _payload_probe {
+      template <typename U> void operator()(U *, long) const {}
+    };
+  } // namespace detail
+
+  /// Does T expose its numbers to the packed reduction ?
+  template <typename T, typename = void> constexpr bool has_mpi_payload = false;
+  template <typename T>
+  constexpr bool has_mpi_payload<T, std::void_t<decltype(mpi_foreach_payload(std::declval<T &>(), detail::_payload_probe{}))>> = true;
+  template <typename T> constexpr bool has_mpi_payload<std::vector<T>> = is_packable_scalar<T> or has_mpi_payload<T>;
+
+  template <typename T, typename F> void mpi_foreach_payload(std::vector<T> &v, F const &f) {
+    if constexpr (is_packable_scalar<T>) {
+      if (!v.empty()) f(v.data(), long(v.size()));
+    } else
+      for (auto &x : v) mpi_foreach_payload(x, f);
+  }
+
+  // Read only : to pack the payload of a const object
+  template <typename T, typename F> void mpi_foreach_payload(std::vector<T> const &v, F const &f) {
+    if constexpr (is_packable_scalar<T>) {
+      if (!v.empty()) f(v.data(), long(v.size()));
+    } else
+      for (auto const &x : v) mpi_foreach_payload(x, f);
+  }
+
+  namespace detail {
+
+    // Maximal number of elements in one MPI call (the count is an int)
+    constexpr long max_mpi_count = 1l << 30;
+
+    template <typename U> constexpr long n_doubles = sizeof(U) / sizeof(double);
+
+    // The payload of an object, packed into buffers.
+    // A sum is done componentwise : all the numbers are then packed as doubles, and reduced with one collective.
+    // Other operations (MPI_PROD...) do not act on the real and imaginary parts separately :
+    // with split_complex, the complex numbers are packed in a second buffer, to be reduced with the complex MPI type.
+    struct packed_buffer {
+      bool split_complex = false;
+      std::vector<double> d;
+      std::vector<std::complex<double>> z;
+
+      // Sizes of the two buffers for the payload of x
+      template <typename T> std::pair<long, long> sizes(T &x) const {
+        long n_d = 0, n_z = 0;
+        mpi_foreach_payload(x, [&](auto *p, long n) {
+          using U = std::remove_const_t<std::remove_pointer_t<decltype(p)>>;
+          static_assert(is_packable_scalar<U>, "mpi packed communication : the payload must be made of double or std::complex<double>");
+          if (split_complex and std::is_same_v<U, std::complex<double>>)
+            n_z += n;
+          else
+            n_d += n * n_doubles<U>;
+        });
+        return {n_d, n_z};
+      }
+
+      template <typename T> void pack(T &x) {
+        auto [n_d, n_z] = sizes(x);
+        d.reserve(n_d);
+        z.reserve(n_z);
+        mpi_foreach_payload(x, [this](auto *p, long n) {
+          using U = std::remove_const_t<std::remove_pointer_t<decltype(p)>>;
+          if constexpr (std::is_same_v<U, std::complex<double>>)
+            if (split_complex) {
+              z.insert(z.end(), p, p + n);
+              return;
+            }
+          auto q = reinterpret_cast<double const *>(p);
+          d.insert(d.end(), q, q + n * n_doubles<U>);
+        });
+      }
+
+      template <typename T> void unpack(T &x) const {
+        if (sizes(x) != std::pair<long, long>(d.size(), z.size()))
+          throw std::runtime_error("mpi packed communication : the result has not the same structure as the object communicated");
+        double const *qd               = d.data();
+        std::complex<double> const *qz = z.data();
+        mpi_foreach_payload(x, [&](auto *p, long n) {
+          using U = std::remove_pointer_t<decltype(p)>;
+          if constexpr (std::is_same_v<U, std::complex<double>>)
+            if (split_complex) {
+              std::copy(qz, qz + n, p);
+              qz += n;
+              return;
+            }
+          std::copy(qd, qd + n * n_doubles<U>, reinterpret_cast<double *>(p));
+          qd += n * n_doubles<U>;
+        });
+      }
+
+      /// Call f(p, count, mpi_datatype) on the chunks of the buffers (the count of an MPI call is an int)
+      template <typename F> void foreach_chunk(F f) {
+        for (long start = 0; start < long(d.size()); start += max_mpi_count)
+          f(static_cast<void *>(d.data() + start), int(std::min(max_mpi_count, long(d.size()) - start)), MPI_DOUBLE);
+        for (long start = 0; start < long(z.size()); start += max_mpi_count)
+          f(static_cast<void *>(z.data() + start), int(std::min(max_mpi_count, long(z.size()) - start)), mpi_type<std::complex<double>>::get());
+      }
+
+      long n_chunks() const {
+        auto n = [](long s) { return (s + max_mpi_count - 1) / max_mpi_count; };
+        return n(d.size()) + n(z.size());
+      }
+    };
+
+    // Pack the payload of x in a buffer, reduce it with one collective (in chunks if very large) and unpack the result into out,
+    // on the nodes receiving it. out must have the same structure as x (sizes of the arrays...) : it can be x itself.
+    template <typename T, typename U> void reduce_packed(T &x, U &out, communicator c, int root, bool all, MPI_Op op) {
+      packed_buffer buf{op != MPI_SUM};
+      buf.pack(x);
+      buf.foreach_chunk([&](void *p, int count, MPI_Datatype t) {
+        if (!all)
+          MPI_Reduce((c.rank() == root ? MPI_IN_PLACE : p), p, count, t, op, root, c.get());
+        else
+          MPI_Allreduce(MPI_IN_PLACE, p, count, t, op, c.get());
+      });
+      if (!all and c.rank() != root) return;
+      buf.unpack(out);
+    }
+
+    template <typename T> void reduce_in_place_packed(T &x, communicator c, int root, bool all, MPI_Op op) { reduce_packed(x, x, c, root, all, op); }
+  } // namespace detail
+
   // ---------------- reduce in place  ---------------------
 
   template <typename T> void mpi_reduce_in_place(std::vector<T> &a, communicator c = {}, int root = 0, bool all = false, MPI_Op op = MPI_SUM) {
@@ -44,8 +179,10 @@ namespace mpi {
         MPI_Reduce((c.rank() == root ? MPI_IN_PLACE : a.data()), a.data(), a.size(), mpi_type<T>::get(), op, root, c.get());
       else
         MPI_Allreduce(MPI_IN_PLACE, a.data(), a.size(), mpi_type<T>::get(), op, c.get());
+    } else if constexpr (has_mpi_payload<T>) {
+      detail::reduce_in_place_packed(a, c, root, all, op);
     } else {
-      for (auto &x : a) mpi_reduce_in_place(a, c, root, all);
+      for (auto &x : a) reduce_in_place(x, c, root, all, op);
     }
   }
 
@@ -54,6 +191,16 @@ namespace mpi {
   namespace detail {
     template <typename T, typename Enable = void> struct _regular { using type = T; };
     template <typename T> struct _regular<T, std::void_t<typename T::regular_type>> { using type = typename T::regular_type; };
+    template <typename T> struct _regular<std::vector<T>> { using type = std::vector<typename _regular<T>::type>; };
+
+    // A copy of x in which the views are replaced by regular objects
+    template <typename T> typename _regular<T>::type make_regular_copy(T const &x) { return typename _regular<T>::type(x); }
+    template <typename T> std::vector<typename _regular<T>::type> make_regular_copy(std::vector<T> const &v) {
+      std::vector<typename _regular<T>::type> r;
+      r.reserve(v.size());
+      for (auto const &x : v) r.push_back(make_regular_copy(x));
+      return r;
+    }
   } // namespace detail
   template <typename T> using regular_t = typename detail::_regular<std::decay_t<T>>::type;
 
@@ -69,6 +216,10 @@ namespace mpi {
       else
         MPI_Allreduce((void *)a.data(), r.data(), s, mpi_type<T>::get(), op, c.get());
       return r;
+    } else if constexpr (has_mpi_payload<regular_t<T>>) { // one collective for all the elements
+      auto r = detail::make_regular_copy(a);
+      detail::reduce_in_place_packed(r, c, root, all, op);
+      return r;
     } else {
       std::vector<regular_t<T>> r;
       r.reserve(s);
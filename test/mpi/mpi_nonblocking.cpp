@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include <mpi/nonblocking.hpp>
+#include <gtest/gtest.h>
+
+#include <complex>
+
+TEST(MPI, nonblocking_reduce) {
+
+  mpi::communicator world;
+  int n = world.size();
+
+  auto f1 = mpi::iall_reduce(world.rank() + 1, world);
+  std::vector<std::complex<double>> A{1, {0, 2}, 3};
+  auto f2 = mpi::ireduce(A, world);
+
+  // both reductions are in flight
+  EXPECT_EQ(f1.get(), n * (n + 1) / 2);
+  auto B = std::move(f2).get();
+  if (world.rank() == 0) EXPECT_EQ(B, (std::vector<std::complex<double>>{double(n), {0, 2.0 * n}, 3.0 * n}));
+  EXPECT_TRUE(f2.ready());
+}
+
+// -----------------------------------
+
+TEST(MPI, nonblocking_reduce_prod) {
+
+  mpi::communicator world;
+  int n = world.size();
+
+  // a packed payload with complex and real numbers : the complex numbers are multiplied as complex
+  std::vector<std::vector<std::complex<double>>> A{{{1, 1}, {0, 2}}, {{1, 0}}};
+  std::vector<std::vector<double>> B{{2, -1}};
+  auto fA = mpi::iall_reduce(A, world, 0, MPI_PROD);
+  auto fB = mpi::iall_reduce(B, world, 0, MPI_PROD);
+  auto rA = std::move(fA).get();
+  EXPECT_NEAR(std::abs(rA[0][0] - std::pow(std::complex<double>{1, 1}, n)), 0, 1.e-12);
+  EXPECT_NEAR(std::abs(rA[0][1] - std::pow(std::complex<double>{0, 2}, n)), 0, 1.e-12);
+  EXPECT_EQ(fB.get()[0][1], std::pow(-1.0, n));
+
+  auto C = A;
+  mpi::all_reduce_in_place(C, world, 0, MPI_PROD);
+  EXPECT_NEAR(std::abs(C[0][0] - rA[0][0]), 0, 1.e-12);
+}
+
+// -----------------------------------
+
+TEST(MPI, nonblocking_broadcast) {
+
+  mpi::communicator world;
+
+  std::vector<std::vector<double>> A{{1, 2}, {3}};
+  if (world.rank() != 0)
+    for (auto &v : A)
+      for (auto &x : v) x = -1;
+
+  auto f = mpi::ibroadcast(A, world);
+  while (!f.ready()) {}
+  EXPECT_EQ(f.get(), (std::vector<std::vector<double>>{{1, 2}, {3}}));
+}
+
+MPI_TEST_MAIN;
@@ -0,0 +1,92 @@
+#include "./nda_test_common.hpp"
+
+using namespace triqs::arrays;
+namespace h5 = triqs::h5;
+
+// ==============================================================
+
+TEST(Array, H5Mapped) {
+
+  array<double, 3> D(10, 3, 4);
+  array<dcomplex, 2> C(7, 5);
+  array<long, 1> L(100);
+  for (int i = 0; i < 10; ++i)
+    for (int j = 0; j < 3; ++j)
+      for (int k = 0; k < 4; ++k) D(i, j, k) = i + 0.1 * j + 0.01 * k;
+  for (int i = 0; i < 7; ++i)
+    for (int j = 0; j < 5; ++j) C(i, j) = dcomplex(i, j);
+  for (int i = 0; i < 100; ++i) L(i) = i * i;
+
+  {
+    h5::file file("h5_mapped.h5", 'w');
+    h5::group top(file);
+    h5_write_contiguous(top, "D", D);
+    h5_write_contiguous(top, "C", C);
+    h5_write_contiguous(top, "L", L);
+    h5_write(top, "D_compressed", D);
+    h5_write_contiguous(top, "D_real", D(range(), 0, range()));
+    h5_write_contiguous(top, "empty", array<double, 2>(0, 3));
+  }
+
+  h5::file file("h5_mapped.h5", 'r');
+  h5::group top(file);
+
+  // contiguous : mapped
+  mapped_array<double, 3> mD(top, "D");
+  EXPECT_TRUE(mD.is_mapped());
+  EXPECT_EQ(mD.shape(), D.shape());
+  EXPECT_ARRAY_EQ(mD(), D);
+  EXPECT_ARRAY_EQ(mD.read_slab(2, 5), D(range(2, 5), range(), range()));
+
+  mapped_array<dcomplex, 2> mC(top, "C");
+  EXPECT_TRUE(mC.is_mapped());
+  EXPECT_ARRAY_EQ(mC(), C);
+
+  mapped_array<long, 1> mL(top, "L");
+  EXPECT_TRUE(mL.is_mapped());
+  EXPECT_ARRAY_EQ(mL(), L);
+
+  // moved : still valid
+  auto mD2 = std::move(mD);
+  EXPECT_FALSE(mD.is_mapped());
+  EXPECT_ARRAY_EQ(mD2(), D);
+
+  // compressed : read with hdf5, by slab or all at once
+  mapped_array<double, 3> mDc(top, "D_compressed");
+  EXPECT_FALSE(mDc.is_mapped());
+  EXPECT_EQ(mDc.shape(), D.shape());
+  EXPECT_ARRAY_EQ(mDc.read_slab(7, 10), D(range(7, 10), range(), range()));
+  EXPECT_ARRAY_EQ(mDc(), D);
+
+  // real in the file, complex in memory : read with hdf5
+  mapped_array<dcomplex, 2> mR(top, "D_real");
+  EXPECT_FALSE(mR.is_mapped());
+  array<dcomplex, 2> R = D(range(), 0, range());
+  EXPECT_ARRAY_EQ(mR.read_slab(1, 3), R(range(1, 3), range()));
+  EXPECT_ARRAY_EQ(mR(), R);
+
+  // another type in the file : read with hdf5
+  mapped_array<int, 1> mI(top, "L");
+  EXPECT_FALSE(mI.is_mapped());
+  EXPECT_EQ(mI()(9), 81);
+
+  mapped_array<double, 2> mE(top, "empty");
+  EXPECT_EQ(mE().shape(), (mini_vector<size_t, 2>{0, 3}));
+
+  EXPECT_THROW(mD2.read_slab(5, 11), triqs::runtime_error);
+  EXPECT_THROW((mapped_array<double, 2>(top, "C")), triqs::runtime_error);
+}
+
+// The file is still open for writing : the data are flushed before being mapped
+TEST(Array, H5MappedWhileWriting) {
+  array<double, 1> A(1000);
+  for (int i = 0; i < 1000; ++i) A(i) = i;
+  h5::file file("h5_mapped2.h5", 'w');
+  h5::group top(file);
+  h5_write_contiguous(top, "A", A);
+  mapped_array<double, 1> mA(top, "A");
+  EXPECT_TRUE(mA.is_mapped());
+  EXPECT_ARRAY_EQ(mA(), A);
+}
+
+MAKE_MAIN;
@@ -1,4 +1,7 @@
 #include "./nda_test_common.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // ==============================================================
 
@@ -136,4 +139,84 @@ TEST(NDA, ExprTemplateArray) {
   C = A + 2 * A + 3 * A - 2 * A + A - A + A + A * 3 + A + A + A + A + A + A + A + A + A + A + A + A + A;
   EXPECT_ARRAY_NEAR(C, array<int, 1>{63, 63, 63});
 }
+// ----------------------------------------------------
+
+// Contiguous operands with the same layout are assigned through the flat (and possibly threaded) path,
+// others through foreach : check both agree.
+TEST(NDA, ExprTemplateFlatAssignment) {
+  using dcomplex = std::complex<double>;
+  auto old_threshold                                    = triqs::arrays::assignment::flat::parallel_threshold;
+  triqs::arrays::assignment::flat::parallel_threshold = 100;
+
+  array<dcomplex, 3> X(20, 3, 4), Y(20, 3, 4), R(20, 3, 4), Yf(20, 3, 4, FORTRAN_LAYOUT);
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 3; ++j)
+      for (int k = 0; k < 4; ++k) {
+        X(i, j, k) = std::sin(i + 2.0 * j + 3.0 * k);
+        Y(i, j, k) = dcomplex(i, j - k);
+      }
+  Yf       = Y;
+  dcomplex a = 2.0 - 1.0_j;
+  double b   = 0.5;
+
+  R = a * X + b * Y;
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 3; ++j)
+      for (int k = 0; k < 4; ++k) EXPECT_COMPLEX_NEAR(R(i, j, k), a * X(i, j, k) + b * Y(i, j, k), 1.e-14);
+
+  // Different layout of one operand : general path
+  array<dcomplex, 3> R2(20, 3, 4);
+  R2 = a * X + b * Yf;
+  EXPECT_ARRAY_NEAR(R, R2, 1.e-14);
+
+  // Compound operations, unary minus, scalar and array RHS
+  R2 = -X;
+  R2 += a * X;
+  R2 -= -Y / 2.0;
+  EXPECT_ARRAY_NEAR(R2, (a - 1.0) * X + Y / 2.0, 1.e-14);
+  R2 *= 2.0;
+  R2 = R2 / 2.0 + X;
+  EXPECT_ARRAY_NEAR(R2, a * X + Y / 2.0, 1.e-14);
+  R2 = Yf;
+  EXPECT_ARRAY_NEAR(R2, Y, 1.e-14);
+  R2 = 3.0;
+  EXPECT_ARRAY_NEAR(R2, array<dcomplex, 3>(a * X * 0.0 + 3.0), 1.e-14);
+
+  // Non contiguous LHS
+  auto R3 = R2(range(0, 20, 2), range(), range());
+  R3      = X(range(0, 20, 2), range(), range()) * 2.0;
+  EXPECT_ARRAY_NEAR(R2(range(0, 20, 2), range(), range()), 2.0 * X(range(0, 20, 2), range(), range()), 1.e-14);
+  EXPECT_ARRAY_NEAR(R2(range(1, 20, 2), range(), range()), array<dcomplex, 3>(10, 3, 4) * 0.0 + 3.0, 1.e-14);
+
+  // Overlapping operands are assigned in memory order, as in the general path
+  array<double, 1> V(1000), V2(1000);
+  for (int i = 0; i < 1000; ++i) V(i) = i;
+  V2                     = V;
+  V(range(0, 999))       = V(range(1, 1000)) + 1.0;
+  for (int i = 0; i < 999; ++i) EXPECT_EQ(V(i), V2(i + 1) + 1.0);
+
+  triqs::arrays::assignment::flat::parallel_threshold = old_threshold;
+}
+
+// Above the threshold, on several threads (the tests are compiled with OpenMP, as the library)
+TEST(NDA, ExprTemplateFlatAssignmentThreads) {
+#ifdef _OPENMP
+  int old_n_threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+#endif
+  long n = 2 * triqs::arrays::assignment::flat::parallel_threshold + 3;
+  array<double, 1> X(n), R(n);
+  for (long i = 0; i < n; ++i) X(i) = std::sin(0.1 * i);
+
+  R = 2.0 * X + 1.0;
+  for (long i = 0; i < n; ++i) ASSERT_EQ(R(i), 2.0 * X(i) + 1.0);
+  R -= X;
+  R *= 2.0;
+  for (long i = 0; i < n; ++i) ASSERT_NEAR(R(i), 2.0 * (X(i) + 1.0), 1.e-14);
+  R = 3.0;
+  EXPECT_EQ(max_element(abs(R - 3.0)), 0);
+#ifdef _OPENMP
+  omp_set_num_threads(old_n_threads);
+#endif
+}
 MAKE_MAIN
@@ -1,6 +1,10 @@
 #include "./nda_test_common.hpp"
 
 #include <triqs/arrays/linalg/det_and_inverse.hpp>
+#include <triqs/arrays/linalg/batched_inverse.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "triqs/arrays/blas_lapack/gtsv.hpp"
 #include <triqs/arrays/blas_lapack/stev.hpp>
 #include <triqs/arrays/blas_lapack/gelss.hpp>
@@ -426,4 +430,214 @@ TEST(eigenelements, test1) {
     test(M);
   }
 }
+
+template <typename T, typename O> void test_eigensolvers(O o) {
+  using linalg::eigensolver;
+  using linalg::spectrum_range;
+  int n = 7;
+  matrix<T> A(n, n, o);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j <= i; ++j) {
+      A(i, j) = std::sin(1.0 + i + 3 * j) + (i == j ? double(i) : 0.0);
+      if (i != j and triqs::is_complex<T>::value) A(i, j) += T(0.5 * std::cos(2.0 * i - j)) * std::sqrt(T(-1));
+      A(j, i) = triqs::utility::conj(A(i, j));
+    }
+  auto ev_ref = linalg::eigenvalues(A);
+
+  auto check = [&](auto const &w, int first) {
+    for (int i = 0; i < first_dim(w.second); ++i) {
+      EXPECT_NEAR(w.first(i), ev_ref(first + i), 1.e-12);
+      EXPECT_ARRAY_NEAR(A * vector<T>(w.second(i, range())), w.first(i) * vector<T>(w.second(i, range())), 1.e-12);
+    }
+  };
+
+  for (auto solver : {eigensolver::syev, eigensolver::syevd, eigensolver::syevr}) {
+    EXPECT_ARRAY_NEAR(linalg::eigenvalues(A, solver), ev_ref, 1.e-12);
+    auto w = linalg::eigenelements(A, solver);
+    EXPECT_EQ(first_dim(w.second), n);
+    check(w, 0);
+
+    // Partial spectra
+    auto w2 = linalg::eigenelements(A, solver, spectrum_range::by_index(2, 5));
+    EXPECT_EQ(w2.first.size(), 3);
+    check(w2, 2);
+    auto w3 = linalg::eigenelements(A, solver, spectrum_range::by_value(ev_ref(0) + 1.e-6, ev_ref(3) + 1.e-6));
+    EXPECT_EQ(w3.first.size(), 3);
+    check(w3, 1);
+    EXPECT_ARRAY_NEAR(linalg::eigenvalues(A, solver, spectrum_range::by_index(0, 1)), ev_ref(range(0, 1)), 1.e-12);
+
+    // Workspace reuse on matrices of the same size
+    linalg::eigenelements_worker<T> worker(solver);
+    for (int k = 0; k < 3; ++k) {
+      matrix<T> B = A + double(k);
+      EXPECT_ARRAY_NEAR(worker.eigenvalues(B), ev_ref + double(k), 1.e-12);
+    }
+  }
+
+  // Batch of matrices
+  array<T, 3> a(4, n, n);
+  for (int b = 0; b < 4; ++b) a(b, range(), range()) = A + double(b);
+  auto [ev, vec] = linalg::eigenelements_batched(a);
+  auto ev2       = linalg::eigenvalues_batched(a, eigensolver::syevr, spectrum_range::by_index(1, 3));
+  for (int b = 0; b < 4; ++b) {
+    EXPECT_ARRAY_NEAR(ev(b, range()), ev_ref + double(b), 1.e-12);
+    EXPECT_ARRAY_NEAR(ev2(b, range()), ev_ref(range(1, 3)) + double(b), 1.e-12);
+    for (int i = 0; i < n; ++i) {
+      vector<T> v = vec(b, i, range());
+      EXPECT_ARRAY_NEAR(A * v, (ev(b, i) - b) * v, 1.e-12);
+    }
+  }
+  EXPECT_THROW(linalg::eigenvalues_batched(a, eigensolver::syevr, spectrum_range::by_value(0, 1)), triqs::runtime_error);
+  EXPECT_THROW(linalg::eigenvalues(A, eigensolver::syevr, spectrum_range::by_index(3, 9)), triqs::runtime_error);
+}
+
+TEST(eigenelements, Solvers) {
+  test_eigensolvers<double>(C_LAYOUT);
+  test_eigensolvers<double>(FORTRAN_LAYOUT);
+  test_eigensolvers<dcomplex>(C_LAYOUT);
+  test_eigensolvers<dcomplex>(FORTRAN_LAYOUT);
+}
+// ==============================================================
+
+template <typename T> void test_batched_inverse() {
+  for (int n = 1; n < 8; ++n) {
+    array<T, 4> a(3, 2, n, n);
+    for (int k = 0; k < 3; ++k)
+      for (int l = 0; l < 2; ++l)
+        for (int i = 0; i < n; ++i)
+          for (int j = 0; j < n; ++j) a(k, l, i, j) = (i == j ? 2.0 + k + l : 0.0) + std::sin(1.0 + i + 3 * j + 7 * k + 11 * l) / n;
+
+    auto b = a;
+    inverse_in_place_batched(b());
+    for (int k = 0; k < 3; ++k)
+      for (int l = 0; l < 2; ++l) EXPECT_ARRAY_NEAR(matrix<T>{inverse(matrix<T>{a(k, l, _, _)})}, b(k, l, _, _), 1.e-12);
+
+    // Strided view, neither of the matrix strides is 1
+    array<T, 4> c(2, n, n, 3);
+    for (int k = 0; k < 3; ++k)
+      for (int l = 0; l < 2; ++l) c(l, _, _, k) = a(k, l, _, _);
+    inverse_in_place_batched(c(_, _, _, 1));
+    for (int l = 0; l < 2; ++l) EXPECT_ARRAY_NEAR(b(1, l, _, _), c(l, _, _, 1), 1.e-12);
+    EXPECT_ARRAY_NEAR(a(0, 1, _, _), c(1, _, _, 0), 1.e-15);
+  }
+}
+
+TEST(BatchedInverse, Double) { test_batched_inverse<double>(); }
+TEST(BatchedInverse, Complex) { test_batched_inverse<std::complex<double>>(); }
+
+TEST(BatchedInverse, BlockDiagonal) {
+  array<std::complex<double>, 3> a(4, 7, 7);
+  a() = 0;
+  auto blocks = std::vector<long>{2, 5};
+  for (int k = 0; k < 4; ++k) {
+    for (int i = 0; i < 7; ++i) a(k, i, i) = 3.0 + k + i;
+    a(k, 0, 1) = 1.0;
+    a(k, 3, 5) = 0.5_j;
+    a(k, 6, 2) = -0.3;
+  }
+  auto b = a;
+  inverse_in_place_batched(b(), blocks);
+  for (int k = 0; k < 4; ++k) EXPECT_ARRAY_NEAR(matrix<std::complex<double>>{inverse(matrix<std::complex<double>>{a(k, _, _)})}, b(k, _, _), 1.e-12);
+
+  EXPECT_THROW(inverse_in_place_batched(b(), {2, 4}), triqs::runtime_error);
+}
+
+TEST(BatchedInverse, Singular) {
+  for (int n : {1, 2, 3, 4, 6}) {
+    array<double, 3> a(2, n, n);
+    a() = (n == 1 ? 0 : 1);
+    EXPECT_THROW(inverse_in_place_batched(a()), triqs::runtime_error);
+  }
+}
+
+// Many matrices, on several threads (the tests are compiled with OpenMP, as the library)
+TEST(BatchedInverse, Threads) {
+#ifdef _OPENMP
+  int old_n_threads = omp_get_max_threads();
+  omp_set_num_threads(4);
+#endif
+  int n_mat = 50, n = 3;
+  array<double, 3> a(n_mat, n, n);
+  for (int k = 0; k < n_mat; ++k)
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j) a(k, i, j) = (i == j ? 2.0 + k : 0.0) + std::sin(1.0 + i + j + 7 * k); // symmetric
+
+  auto b = a;
+  inverse_in_place_batched(b());
+  auto ev = linalg::eigenvalues_batched(a);
+  for (int k = 0; k < n_mat; ++k) {
+    EXPECT_ARRAY_NEAR(matrix<double>{inverse(matrix<double>{a(k, _, _)})}, b(k, _, _), 1.e-12);
+    EXPECT_ARRAY_NEAR(linalg::eigenvalues(matrix<double>{a(k, _, _)}), ev(k, _), 1.e-12);
+  }
+
+  // the error of one thread is rethrown
+  a(n_mat / 2, _, _) = 0;
+  EXPECT_THROW(inverse_in_place_batched(a()), triqs::runtime_error);
+#ifdef _OPENMP
+  omp_set_num_threads(old_n_threads);
+#endif
+}
+
+// ==============================================================
+
+// The small matrix kernels (dimensions <= 8) against the generic product and LAPACK
+template <typename T, typename O> void test_small_matrix(O o) {
+  auto fill = [](auto &&m, double shift) {
+    for (int i = 0; i < first_dim(m); ++i)
+      for (int j = 0; j < second_dim(m); ++j) m(i, j) = (i == j ? 3.0 : 0.0) + std::sin(shift + i + 2.3 * j);
+  };
+  T alpha = 1.5, beta = -0.5;
+  for (int n = 1; n <= 9; ++n) {
+    matrix<T> A(n, n + 1 > 9 ? n : n + 1, o), B(second_dim(A), n, FORTRAN_LAYOUT), C(n, n, o);
+    fill(A, 0), fill(B, 1), fill(C, 2);
+
+    // C = alpha A B + beta C
+    matrix<T> R = beta * C, AB(n, n);
+    blas::gemm_generic(1, A, B, 0, AB);
+    R += alpha * AB;
+    blas::gemm(alpha, A, B, beta, C);
+    EXPECT_ARRAY_NEAR(C, R, 1.e-13);
+    EXPECT_ARRAY_NEAR(matrix<T>{A * B}, AB, 1.e-13);
+
+    // Strided views
+    array<T, 3> S(n, 3, n);
+    fill(S(_, 1, _), 3);
+    matrix_view<T> V = S(_, 1, _);
+    matrix<T> W      = V * V, W2(n, n);
+    blas::gemm_generic(1, V, V, 0, W2);
+    EXPECT_ARRAY_NEAR(W, W2, 1.e-13);
+
+    // y = alpha A x + beta y
+    vector<T> x(second_dim(A)), y(n);
+    for (int i = 0; i < x.size(); ++i) x(i) = std::cos(i);
+    for (int i = 0; i < n; ++i) y(i) = i;
+    vector<T> ry = beta * y, Ax(n);
+    blas::gemv_generic(1, A, x, 0, Ax);
+    ry += alpha * Ax;
+    blas::gemv(alpha, A, x, beta, y);
+    EXPECT_ARRAY_NEAR(y, ry, 1.e-13);
+    EXPECT_ARRAY_NEAR(vector<T>(A * x), Ax, 1.e-13);
+
+    // inverse and determinant against getrf/getri
+    matrix<T> M(n, n, o);
+    fill(M, 4);
+    auto Mi = M;
+    det_and_inverse_worker<matrix_view<T>> worker{Mi};
+    T d = worker.det();
+    worker.inverse();
+    EXPECT_COMPLEX_NEAR(determinant(M), d, 1.e-12);
+    EXPECT_ARRAY_NEAR(matrix<T>{inverse(M)}, Mi, 1.e-12);
+    EXPECT_ARRAY_NEAR(matrix<T>{inverse(V)}, matrix<T>{inverse(matrix<T>{V})}, 1.e-12);
+  }
+}
+
+TEST(SmallMatrix, Double) {
+  test_small_matrix<double>(C_LAYOUT);
+  test_small_matrix<double>(FORTRAN_LAYOUT);
+}
+TEST(SmallMatrix, Complex) {
+  test_small_matrix<std::complex<double>>(C_LAYOUT);
+  test_small_matrix<std::complex<double>>(FORTRAN_LAYOUT);
+}
+
 MAKE_MAIN
@@ -136,4 +136,24 @@ TEST(Arrays, array_transpose_bcast) {
   EXPECT_ARRAY_EQ(At, B);
 }
 
+// ----------------------------------------
+
+TEST(Arrays, MPIBroadcastShared) {
+
+  mpi::communicator world;
+
+  array<double, 3> A(4, 3, 2), empty;
+  clef::placeholder<0> i_;
+  clef::placeholder<1> j_;
+  clef::placeholder<2> k_;
+  A(i_, j_, k_) << i_ + 10 * j_ + 100 * k_;
+
+  // the array is only given on root, as a non contiguous view
+  int root = world.size() - 1;
+  auto s   = mpi::broadcast_shared((world.rank() == root ? A(range(), range(0, 3, 2), range()) : empty()), world, root);
+
+  EXPECT_EQ(s.shape(), (mini_vector<size_t, 3>{4, 2, 2}));
+  EXPECT_ARRAY_EQ(s(), A(range(), range(0, 3, 2), range()));
+}
+
 MAKE_MAIN;
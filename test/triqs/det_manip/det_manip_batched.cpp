@@ -0,0 +1,92 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+  using result_type   = double;
+  using argument_type = double;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r);
+  }
+};
+
+// The same function, with the batched protocol. It counts the calls of each kind.
+struct fun_batched : fun {
+  int *n_scalar, *n_batched;
+  fun_batched(int *n_s, int *n_b) : n_scalar(n_s), n_batched(n_b) {}
+
+  double operator()(double x, double y) const {
+    ++*n_scalar;
+    return fun::operator()(x, y);
+  }
+  void row(double x, std::vector<double> const &Y, triqs::arrays::vector_view<double> out) const {
+    ++*n_batched;
+    for (int k = 0; k < Y.size(); ++k) out(k) = fun::operator()(x, Y[k]);
+  }
+  void col(std::vector<double> const &X, double y, triqs::arrays::vector_view<double> out) const {
+    ++*n_batched;
+    for (int k = 0; k < X.size(); ++k) out(k) = fun::operator()(X[k], y);
+  }
+  void matrix(std::vector<double> const &X, std::vector<double> const &Y, triqs::arrays::matrix_view<double> out) const {
+    ++*n_batched;
+    for (int i = 0; i < X.size(); ++i)
+      for (int j = 0; j < Y.size(); ++j) out(i, j) = fun::operator()(X[i], Y[j]);
+  }
+};
+
+static_assert(triqs::det_manip::has_batched_row<fun_batched, double, double, double>::value);
+static_assert(!triqs::det_manip::has_batched_row<fun, double, double, double>::value);
+
+TEST(DetManip, Batched) {
+  int n_scalar = 0, n_batched = 0;
+  std::vector<double> X{1, 2, 2.5, 4}, Y{3, 4, 9, 0.5};
+  triqs::det_manip::det_manip<fun> D1(fun{}, X, Y);
+  triqs::det_manip::det_manip<fun_batched> D2(fun_batched{&n_scalar, &n_batched}, X, Y);
+  EXPECT_EQ(n_scalar, 0);
+
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> rnd(0, 10);
+  for (int n = 0; n < 200; ++n) {
+    int s = D1.size();
+    double x = rnd(gen), y = rnd(gen), x1 = rnd(gen), y1 = rnd(gen);
+    int i = gen() % (s + 1), j = gen() % (s + 1);
+    double r1 = 0, r2 = 0;
+    switch (s < 2 ? 0 : n % 6) {
+      case 0: r1 = D1.try_insert(i, j, x, y), r2 = D2.try_insert(i, j, x, y); break;
+      case 1: r1 = D1.try_insert2(0, s, 0, s, x, x1, y, y1), r2 = D2.try_insert2(0, s, 0, s, x, x1, y, y1); break;
+      case 2: r1 = D1.try_remove(i % s, j % s), r2 = D2.try_remove(i % s, j % s); break;
+      case 3: r1 = D1.try_change_col(j % s, y), r2 = D2.try_change_col(j % s, y); break;
+      case 4: r1 = D1.try_change_row(i % s, x), r2 = D2.try_change_row(i % s, x); break;
+      case 5: r1 = D1.try_change_col_row(i % s, j % s, x, y), r2 = D2.try_change_col_row(i % s, j % s, x, y); break;
+    }
+    EXPECT_NEAR(r1, r2, 1.e-10 * std::abs(r1));
+    if (std::abs(r1) > 0.1 and std::abs(r1) < 10) {
+      D1.complete_operation();
+      D2.complete_operation();
+    } else {
+      D1.reject_last_try();
+      D2.reject_last_try();
+    }
+    if (n % 50 == 49) {
+      EXPECT_ARRAY_NEAR(D1.inverse_matrix(), D2.inverse_matrix(), 1.e-8);
+      D1.regenerate();
+      D2.regenerate();
+    }
+  }
+  EXPECT_NEAR(D1.determinant(), D2.determinant(), 1.e-8 * std::abs(D1.determinant()));
+  EXPECT_ARRAY_NEAR(triqs::arrays::matrix<double>(inverse(D2.matrix())), D2.inverse_matrix(), 1.e-8);
+  EXPECT_GT(n_batched, 0);
+
+  auto r1 = D1.try_refill(X, Y), r2 = D2.try_refill(X, Y);
+  EXPECT_NEAR(r1, r2, 1.e-10 * std::abs(r1));
+}
+
+MAKE_MAIN;
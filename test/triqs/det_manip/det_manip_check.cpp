@@ -0,0 +1,86 @@
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/det_manip/det_manip.hpp>
+#include <random>
+
+struct fun {
+  using result_type   = double;
+  using argument_type = double;
+  double const *shift;
+
+  double operator()(double x, double y) const {
+    const double pi   = acos(-1);
+    const double beta = 10.0;
+    const double epsi = 0.1;
+    double tau        = x - y;
+    bool s            = (tau > 0);
+    tau               = (s ? tau : beta + tau);
+    double r          = epsi + tau / beta * (1 - 2 * epsi);
+    return -2 * (pi / beta) / std::sin(pi * r) + *shift * (x == y ? 1 : 0);
+  }
+};
+
+// Random insertions and removals, with the probing check and the full check
+TEST(DetManip, ProbeCheck) {
+  double shift = 0;
+  std::vector<double> X{1, 2, 2.5, 4}, Y{3, 4, 9, 0.5};
+  triqs::det_manip::det_manip<fun> D1(fun{&shift}, X, Y), D2(fun{&shift}, X, Y);
+  D1.set_n_operations_before_check(10);
+  D2.set_n_operations_before_check(10);
+  D2.set_n_probes_per_check(2);
+  EXPECT_EQ(D2.get_n_probes_per_check(), 2);
+
+  std::mt19937 gen(23432);
+  std::uniform_real_distribution<> rnd(0, 10);
+  for (int n = 0; n < 500; ++n) {
+    int s = D1.size();
+    if (s < 2 or (s < 20 and gen() % 2)) {
+      double x = rnd(gen), y = rnd(gen);
+      int i = gen() % (s + 1), j = gen() % (s + 1);
+      double r = D1.try_insert(i, j, x, y);
+      D2.try_insert(i, j, x, y);
+      if (std::abs(r) < 0.1 or std::abs(r) > 10) {
+        D1.reject_last_try();
+        D2.reject_last_try();
+        continue;
+      }
+    } else {
+      int i = gen() % s, j = gen() % s;
+      D1.try_remove(i, j);
+      D2.try_remove(i, j);
+    }
+    D1.complete_operation();
+    D2.complete_operation();
+    EXPECT_NEAR(D1.determinant() / D2.determinant(), 1, 1.e-8);
+  }
+
+  auto const &st = D2.get_check_stats();
+  EXPECT_GT(st.n_checks, 10);
+  EXPECT_EQ(st.n_regenerations, 0);
+  EXPECT_LT(st.max_deviation, 1.e-8);
+  EXPECT_EQ(D1.get_check_stats().n_checks, D1.get_check_stats().n_regenerations);
+  EXPECT_ARRAY_NEAR(D1.inverse_matrix(), D2.inverse_matrix(), 1.e-8);
+
+  D2.reset_check_stats();
+  EXPECT_EQ(D2.get_check_stats().n_checks, 0);
+}
+
+// A deviation of M^-1 is found by the probes, and repaired by a full regeneration
+TEST(DetManip, ProbeCheckRegenerates) {
+  double shift = 0;
+  std::vector<double> X{1, 2, 2.5, 4}, Y{1, 4, 9, 0.5};
+  triqs::det_manip::det_manip<fun> D(fun{&shift}, X, Y);
+  D.set_n_operations_before_check(0);
+  D.set_n_probes_per_check(1);
+  D.set_precision_error(1.e10); // only warn
+
+  // M(0, 0) changes behind the back of D : M^-1 is now wrong. The next operation does not touch column 0.
+  shift = 0.5;
+  D.try_change_col(1, 4);
+  D.complete_operation();
+  auto const &st = D.get_check_stats();
+  EXPECT_EQ(st.n_regenerations, 1);
+  EXPECT_GT(st.max_deviation, 1.e-3);
+  EXPECT_ARRAY_NEAR(D.inverse_matrix(), triqs::arrays::matrix<double>(inverse(D.matrix())), 1.e-10);
+}
+
+MAKE_MAIN;
@@ -149,4 +149,58 @@ TEST(FitTailMatsubara, Multivar) { // NOLINT
   EXPECT_ARRAY_NEAR(tail_exact, tail(range(5), range(), range(), 0, 0), 1e-6);
 }
 
+// ------------------------------------------------------------------------------
+
+TEST(FitTailMatsubara, BlockBatched) { // NOLINT
+
+  triqs::clef::placeholder<0> iw_;
+  double beta = 10;
+  int N       = 100;
+
+  auto iw_mesh = gf_mesh<imfreq>{beta, Fermion, N};
+
+  // Three blocks with different poles, sharing the mesh
+  auto g  = gf<imfreq>{iw_mesh, {2, 2}};
+  auto bg = make_block_gf({g, g, g});
+  for (int b : range(3)) {
+    for (auto iw : iw_mesh) {
+      bg[b][iw] = 0.0;
+      for (int i : range(2)) bg[b][iw](i, i) = 1 / (dcomplex(iw) - 0.5 * (b + i));
+    }
+  }
+
+  auto known_moments    = array<dcomplex, 3>(2, 2, 2);
+  known_moments(0, range(), range()) = 0.0;
+  known_moments(1, range(), range()) = make_unit_matrix<dcomplex>(2);
+  auto km_vec           = std::vector<array<dcomplex, 3>>{known_moments, known_moments, known_moments};
+
+  // The batched fit of all the blocks gives the result of the individual fits
+  for (bool with_km : {false, true}) {
+    auto [tails, err] = with_km ? fit_tail(bg, km_vec) : fit_tail(bg);
+    auto [tails_h, err_h] = with_km ? fit_hermitian_tail(bg, km_vec) : fit_hermitian_tail(bg);
+    ASSERT_EQ(3, tails.size());
+    double max_err = 0;
+    for (int b : range(3)) {
+      auto [tail_b, err_b] = with_km ? fit_tail(bg[b], known_moments) : fit_tail(bg[b]);
+      EXPECT_ARRAY_NEAR(tail_b, tails[b], 1e-12);
+      auto tail_h_b = (with_km ? fit_hermitian_tail(bg[b], known_moments) : fit_hermitian_tail(bg[b])).first;
+      EXPECT_ARRAY_NEAR(tail_h_b, tails_h[b], 1e-12);
+      max_err = std::max(max_err, err_b);
+
+      for (int i : range(2)) {
+        dcomplex pole = 0.5 * (b + i);
+        EXPECT_ARRAY_NEAR((array<dcomplex, 1>{dcomplex(0.0), dcomplex(1.0), pole, pole * pole}), tails[b](range(4), i, i), 1e-6);
+      }
+    }
+    EXPECT_NEAR(max_err, err, 1e-14);
+  }
+
+  // Blocks on different meshes are fitted one by one
+  auto bg2         = make_block_gf({g, gf<imfreq>{{beta, Fermion, 2 * N}, {2, 2}}});
+  bg2[0]           = bg[0];
+  bg2[1](iw_)      << 1 / (iw_ - 1.0);
+  auto [tails2, e] = fit_tail(bg2);
+  EXPECT_ARRAY_NEAR(fit_tail(bg2[1]).first, tails2[1], 1e-12);
+}
+
 MAKE_MAIN;
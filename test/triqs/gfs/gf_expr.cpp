@@ -0,0 +1,110 @@
+#include <triqs/test_tools/gfs.hpp>
+
+// Expressions evaluated in a single pass on the data are compared to the point by point evaluation
+
+struct GfExpr : ::testing::Test {
+  double beta = 10;
+  gf<imfreq> g1{{beta, Fermion, 20}, {2, 2}}, g2{g1};
+  gf<imfreq, scalar_valued> s1{{beta, Fermion, 20}}, s2{s1};
+
+  GfExpr() {
+    for (auto w : g1.mesh()) {
+      dcomplex z = w;
+      g1[w]      = matrix<dcomplex>{{z - 1.0, 0.5_j}, {0.5_j, z + 1.0}};
+      g2[w]      = matrix<dcomplex>{{0.1_j, 1_j}, {-1_j, 2.0 / z}};
+      s1[w] = dcomplex(w) - 0.3;
+      s2[w] = 1 / dcomplex(w);
+    }
+  }
+
+  // Reference : point by point
+  template <typename G, typename E> G pointwise(G const &g, E const &e) {
+    G r = g;
+    for (auto w : r.mesh()) r[w] = e[w];
+    return r;
+  }
+};
+
+TEST_F(GfExpr, Elementwise) {
+  static_assert(gfs_expr_tools::is_fusable<std::decay_t<decltype(2 * g1 - g2 / 3.0)>>::value);
+  static_assert(gfs_expr_tools::is_fusable<std::decay_t<decltype(s1 * s2 + 1 / s1 - 2 * s2)>>::value);
+
+  gf<imfreq> g = 2 * g1 - g2 / 3.0 + (-g1);
+  EXPECT_GF_NEAR(g, pointwise(g1, 2 * g1 - g2 / 3.0 + (-g1)));
+
+  gf<imfreq, scalar_valued> s = s1 * s2 + 1 / s1 - 2 * s2;
+  EXPECT_GF_NEAR(s, pointwise(s1, s1 * s2 + 1 / s1 - 2 * s2));
+
+  // into a view
+  g()  = g1 + 1_j * g2;
+  EXPECT_GF_NEAR(g, pointwise(g1, g1 + 1_j * g2));
+}
+
+TEST_F(GfExpr, MatrixOperations) {
+  // matrix product and inverse are not element by element
+  static_assert(!gfs_expr_tools::is_fusable<std::decay_t<decltype(g1 * g2)>>::value);
+  static_assert(!gfs_expr_tools::is_fusable<std::decay_t<decltype(1 / g1)>>::value);
+
+  gf<imfreq> g = g1 * g2 + g2 / g1;
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(g1[w] * g2[w] + g2[w] * inverse(g1[w])));
+}
+
+TEST_F(GfExpr, Functions) {
+  // Dyson equation
+  gf<imfreq> g = inverse(inverse(g1) - g2);
+  for (auto w : g.mesh()) {
+    matrix<dcomplex> m = inverse(g1[w]);
+    m                  = m - g2[w];
+    EXPECT_ARRAY_NEAR(matrix<dcomplex>(g[w]), matrix<dcomplex>(inverse(m)));
+  }
+
+  gf<imfreq> c = conj(g1 - g2);
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(c[w]), conj(matrix<dcomplex>(g1[w] - g2[w])));
+
+  gf<imfreq> t = transpose(g1 + g2);
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(t[w]), transpose(matrix<dcomplex>(g1[w] + g2[w])));
+
+  matrix<dcomplex> m{{1.0_j, 2_j}, {3_j, 4.0 + 0_j}};
+  gf<imfreq> gm = g2 * m;
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(gm[w]), matrix<dcomplex>(g2[w] * m));
+}
+
+TEST(GfMatrixProduct, LargeMesh) {
+  // more rows than the scratch buffer of the product by a matrix : several blocks
+  auto g = gf<imfreq>{{10, Fermion, 20000}, {2, 2}};
+  for (auto w : g.mesh()) g[w] = matrix<dcomplex>{{dcomplex(w), 1_j}, {2.0 + 0_j, 1.0 / dcomplex(w)}};
+  matrix<dcomplex> m{{1.0_j, 2_j}, {3_j, 4.0 + 0_j}};
+  gf<imfreq> gm = g * m;
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(gm[w]), matrix<dcomplex>(g[w] * m));
+  gf<imfreq> mg = m * g;
+  for (auto w : g.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(mg[w]), matrix<dcomplex>(m * g[w]));
+
+  // rectangular target
+  auto g2 = gf<imfreq>{{10, Fermion, 5}, {2, 3}};
+  for (auto w : g2.mesh()) g2[w] = matrix<dcomplex>{{dcomplex(w), 1_j, 2.0 + 0_j}, {3.0 + 0_j, 1.0 / dcomplex(w), 0_j}};
+  gf<imfreq> mg2 = m * g2;
+  for (auto w : g2.mesh()) EXPECT_ARRAY_NEAR(matrix<dcomplex>(mg2[w]), matrix<dcomplex>(m * g2[w]));
+}
+
+TEST(GfCopy, BulkData) {
+  double beta = 10;
+  using var_t = cartesian_product<imfreq, imtime>;
+  auto g      = gf<var_t, matrix_valued>{{{beta, Fermion, 10}, {beta, Fermion, 11}}, {2, 2}};
+  for (auto [w, t] : g.mesh()) g[w, t] = matrix<dcomplex>{{dcomplex(w), double(t) + 0_j}, {1.0 + 0_j, dcomplex(w) * double(t)}};
+
+  gf<var_t, matrix_valued> g2;
+  g2 = g();
+  EXPECT_ARRAY_NEAR(g2.data(), g.data());
+  EXPECT_EQ(g2.mesh(), g.mesh());
+
+  // into a view, also from a slice of the target
+  auto g3 = gf<var_t, scalar_valued>{g.mesh()};
+  g3()    = slice_target_to_scalar(g, 1, 0);
+  EXPECT_ARRAY_NEAR(g3.data(), g.data()(range(), range(), 1, 0));
+
+  // the target shapes must be the same
+  auto g4 = gf<var_t, matrix_valued>{g.mesh(), {3, 3}};
+  EXPECT_THROW(g4() = g, triqs::runtime_error);
+}
+
+MAKE_MAIN;
@@ -66,4 +66,21 @@ TEST(CtHyb, gf_inverse3) {
   EXPECT_GF_NEAR(G_iw, G_iw_inv);
 }
 
+TEST(CtHyb, gf_inverse_block_diagonal) {
+  double beta = 10.0;
+  int n_iw    = 20;
+
+  // Target matrices with diagonal blocks of size 1 and 5
+  auto G_iw = gf<imfreq>{{beta, Fermion, n_iw}, {6, 6}};
+  for (auto iw : G_iw.mesh()) {
+    G_iw[iw] = 0;
+    for (int i = 0; i < 6; ++i) G_iw[iw](i, i) = dcomplex(iw) - 0.1 * i;
+    for (int i = 1; i < 5; ++i) G_iw[iw](i, i + 1) = G_iw[iw](i + 1, i) = 0.3;
+  }
+
+  auto G_iw_inv = inverse(G_iw);
+  invert_in_place(G_iw(), {1, 5});
+  EXPECT_GF_NEAR(G_iw, G_iw_inv);
+}
+
 MAKE_MAIN;
@@ -0,0 +1,59 @@
+#include <triqs/test_tools/gfs.hpp>
+
+double beta = 10, eps = 1.3;
+
+// a single level
+double g_exact(double tau) { return -std::exp(-eps * tau) / (1 + std::exp(-beta * eps)); }
+
+TEST(ImTimeSpline, Accuracy) {
+  // a coarse mesh
+  auto g = gf<imtime, scalar_real_valued>{{beta, Fermion, 101}};
+  for (auto t : g.mesh()) g[t] = g_exact(t);
+
+  auto s = make_imtime_spline(g);
+
+  double err_spline = 0, err_lin = 0;
+  for (int i = 0; i <= 997; ++i) {
+    double tau = beta * i / 997;
+    err_spline = std::max(err_spline, std::abs(s(tau) - g_exact(tau)));
+    err_lin    = std::max(err_lin, std::abs(g(tau) - g_exact(tau)));
+  }
+  EXPECT_LT(err_spline, 1.e-5);
+  EXPECT_LT(err_spline, 1.e-2 * err_lin);
+
+  // exact on the mesh
+  for (auto t : g.mesh()) EXPECT_NEAR(s(double(t)), g[t], 1.e-14);
+
+  EXPECT_THROW(s(beta * 1.01), triqs::runtime_error);
+}
+
+TEST(ImTimeSpline, MatrixBatch) {
+  auto g = gf<imtime>{{beta, Fermion, 50}, {2, 3}};
+  for (auto t : g.mesh())
+    for (int a = 0; a < 2; ++a)
+      for (int b = 0; b < 3; ++b) g[t](a, b) = dcomplex(a - b, a + b) * std::cos(double(t) * (1 + a + b));
+
+  auto s = make_imtime_spline(g);
+
+  // the elements are independent : compare to the spline of each element
+  auto s01 = make_imtime_spline(slice_target_to_scalar(g, 0, 1));
+
+  triqs::utility::time_segment seg(beta);
+  std::vector<triqs::utility::time_pt> pts;
+  array<double, 1> taus(20);
+  for (int i = 0; i < 20; ++i) {
+    pts.push_back(seg.make_time_pt(beta * i / 19));
+    taus(i) = double(pts.back());
+  }
+
+  auto r1 = s(taus);
+  auto r2 = s(pts);
+  EXPECT_EQ(r1.shape(), (mini_vector<size_t, 3>{20, 2, 3}));
+  EXPECT_ARRAY_NEAR(r1, r2);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_ARRAY_NEAR(r1(i, range(), range()), s(taus(i)));
+    EXPECT_COMPLEX_NEAR(r1(i, 0, 1), s01(pts[i]), 1.e-14);
+  }
+}
+
+MAKE_MAIN;
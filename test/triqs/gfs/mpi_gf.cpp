@@ -136,6 +136,84 @@ TEST_F(MpiGf, ReduceBlockView) {
 
 //----------------------------------------------
 
+TEST_F(MpiGf, ReduceBlock2) {
+  // all the blocks are reduced in a single collective
+  auto g2   = gf<imfreq>{g1.mesh(), {2, 2}};
+  g2.data() = 1 + world.rank();
+  auto names = std::vector<std::vector<std::string>>{{"a", "b"}, {"x", "y", "z"}};
+  block2_gf<imfreq> b2{names, std::vector<std::vector<gf<imfreq>>>(2, std::vector<gf<imfreq>>(3, g2))};
+  array<dcomplex, 3> sum(g2.data().shape());
+  sum() = world.size() * (world.size() + 1) / 2.0;
+
+  block2_gf<imfreq> r = mpi::all_reduce(b2);
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 3; ++j) EXPECT_ARRAY_NEAR(r(i, j).data(), sum);
+
+  auto b3 = b2;
+  b3()    = mpi::reduce(b2);
+  if (world.rank() == 0) EXPECT_ARRAY_NEAR(b3(1, 2).data(), r(1, 2).data());
+  EXPECT_ARRAY_NEAR(b2(1, 2).data(), g2.data());
+}
+
+//----------------------------------------------
+
+TEST_F(MpiGf, ReduceVectorOfArrays) {
+  std::vector<array<dcomplex, 3>> v{g1.data(), 2 * g1.data()};
+  std::vector<array<double, 1>> w{array<double, 1>{1, 2}, array<double, 1>{3}};
+
+  auto rv = mpi::all_reduce(v);
+  EXPECT_ARRAY_NEAR(rv[1], 2 * world.size() * g1.data());
+
+  mpi::all_reduce_in_place(w);
+  EXPECT_ARRAY_NEAR(w[0], world.size() * array<double, 1>{1, 2});
+  EXPECT_ARRAY_NEAR(w[1], world.size() * array<double, 1>{3});
+}
+
+//----------------------------------------------
+
+TEST_F(MpiGf, NonBlocking) {
+  block_gf<imfreq> bgf = make_block_gf({g1, g1});
+
+  // start all the communications, then wait for them
+  auto f1 = mpi::iall_reduce(g1, world);
+  auto f2 = mpi::ireduce(bgf, world);
+  auto f3 = mpi::iall_reduce(g1.data()(range(0, 3), 0, 0), world);
+  auto f4 = mpi::ibroadcast(bgf, world);
+
+  EXPECT_ARRAY_NEAR(f1.get().data(), world.size() * g1.data());
+  if (world.rank() == 0) EXPECT_ARRAY_NEAR(f2.get()[1].data(), world.size() * g1.data());
+  EXPECT_ARRAY_NEAR(f3.get(), world.size() * g1.data()(range(0, 3), 0, 0));
+  EXPECT_ARRAY_NEAR(f4.get()[0].data(), g1.data());
+}
+
+//----------------------------------------------
+
+TEST_F(MpiGf, ReduceProdComplex) {
+  // MPI_PROD acts on the complex numbers, not separately on their real and imaginary parts
+  auto g2   = gf<imfreq>{g1.mesh(), {1, 1}};
+  g2.data() = dcomplex(1, 1);
+  array<dcomplex, 3> prod(g2.data().shape());
+  prod() = std::pow(dcomplex(1, 1), world.size());
+
+  std::vector<gf<imfreq>> v{g2, g2};
+  auto rv = mpi::all_reduce(v, world, 0, MPI_PROD);
+  EXPECT_ARRAY_NEAR(rv[1].data(), prod);
+
+  block_gf<imfreq> b{{"a", "b"}, {g2, g2}};
+  block_gf<imfreq> rb = mpi::all_reduce(b, world, 0, MPI_PROD);
+  EXPECT_ARRAY_NEAR(rb[0].data(), prod);
+
+  // into a view
+  auto b2 = b;
+  b2()    = mpi::all_reduce(b, world, 0, MPI_PROD);
+  EXPECT_ARRAY_NEAR(b2[1].data(), prod);
+
+  auto f = mpi::iall_reduce(b, world, 0, MPI_PROD);
+  EXPECT_ARRAY_NEAR(f.get()[1].data(), prod);
+}
+
+//----------------------------------------------
+
 //TEST_F(MpiGf, final) {
 //auto g10 = gf<imfreq>{{beta, Fermion, Nfreq}, {1, 1}};
 //g10(w_) << 1 / (w_ + 1);
@@ -0,0 +1,84 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs/transform/pade.hpp>
+#include <triqs/utility/pade_approximants.hpp>
+
+using triqs::utility::pade_approximant;
+
+// Two Lorentzians
+dcomplex G1(dcomplex z) { return 0.7 / (z - 2.6 + 0.3_j) + 0.3 / (z + 3.4 + 0.1_j); }
+dcomplex G2(dcomplex z) { return 1.0 / (z - 0.5 + 0.2_j); }
+
+TEST(Pade, Approximant) {
+  double beta = 100;
+  int N       = 8;
+  triqs::arrays::vector<dcomplex> z(N), u(N);
+  for (int n = 0; n < N; ++n) {
+    z(n) = 1_j * M_PI * (2 * n + 1) / beta;
+    u(n) = G1(z(n));
+  }
+
+  pade_approximant PA_gmp(z, u);
+  EXPECT_TRUE(PA_gmp.uses_multiprecision());
+
+  // A rational function of low degree is recovered without GMP floats
+  pade_approximant PA(z, u, true);
+  EXPECT_FALSE(PA.uses_multiprecision());
+  for (double x : {-3.0, -1.0, 0.0, 1.5, 2.6}) {
+    dcomplex e = x + 0.05_j;
+    EXPECT_COMPLEX_NEAR(G1(e), PA_gmp(e), 1.e-8);
+    EXPECT_COMPLEX_NEAR(G1(e), PA(e), 1.e-8);
+  }
+
+  // Many points of a function with a branch cut : the long double coefficients lose precision
+  int M = 40;
+  triqs::arrays::vector<dcomplex> z2(M), u2(M);
+  for (int n = 0; n < M; ++n) {
+    z2(n) = 1_j * M_PI * (2 * n + 1) / beta;
+    u2(n) = 2.0 * (z2(n) - 1_j * std::sqrt(1.0 - z2(n) * z2(n)));
+  }
+  pade_approximant PA2(z2, u2, true);
+  EXPECT_TRUE(PA2.uses_multiprecision());
+  pade_approximant PA2_gmp(z2, u2);
+  EXPECT_COMPLEX_NEAR(PA2_gmp(0.3 + 0.1_j), PA2(0.3 + 0.1_j), 1.e-14);
+}
+
+TEST(Pade, MatrixValued) {
+  double beta = 100;
+  int L       = 10;
+  double eta  = 0.01;
+
+  auto gw = gf<imfreq>{{beta, Fermion, 100}, {3, 3}};
+  for (auto iw : gw.mesh()) {
+    gw[iw]       = 0;
+    gw[iw](0, 0) = G1(iw);
+    gw[iw](1, 1) = G1(iw); // degenerate with (0,0)
+    gw[iw](2, 2) = G2(iw);
+    gw[iw](0, 2) = 0.1 * G2(iw);
+  }
+
+  auto gr = gf<refreq>{{-5.995, 5.995, 1200}, {3, 3}};
+  pade(gr, gw, L, eta);
+
+  auto gr_adapt = gr;
+  pade(gr_adapt, gw, L, eta, true);
+  EXPECT_GF_NEAR(gr, gr_adapt, 1.e-6);
+
+  // Each element agrees with its own continuation
+  for (auto [n1, n2] : std::vector<std::pair<int, int>>{{0, 0}, {1, 1}, {2, 2}, {0, 2}, {1, 0}}) {
+    auto gw_s = gf<imfreq, scalar_valued>{gw.mesh()};
+    for (auto iw : gw.mesh()) gw_s[iw] = gw[iw](n1, n2);
+    auto gr_s = gf<refreq, scalar_valued>{gr.mesh()};
+    pade(gr_s, gw_s, L, eta);
+    EXPECT_ARRAY_NEAR(gr_s.data(), gr.data()(range(), n1, n2));
+  }
+
+  for (auto om : gr.mesh()) {
+    dcomplex e = om + 1_j * eta;
+    if (std::abs(double(om)) > 4) continue;
+    EXPECT_COMPLEX_NEAR(G1(e), gr[om](1, 1), 1.e-6);
+    EXPECT_COMPLEX_NEAR(G2(e), gr[om](2, 2), 1.e-6);
+    EXPECT_COMPLEX_NEAR(0.0, gr[om](1, 0), 1.e-12);
+  }
+}
+
+MAKE_MAIN;
@@ -0,0 +1,115 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/mc_tools/mc_reduction.hpp>
+
+mpi::communicator world;
+
+// A block with a non symmetric, complex target
+gf<imfreq> make_g(double a) {
+  auto g = gf<imfreq>({10, Fermion, 5}, {2, 2});
+  for (auto const &w : g.mesh()) {
+    dcomplex z = w;
+    g[w]       = matrix<dcomplex>{{1. / (z + a), 1_j / (z - 1.)}, {dcomplex(0.5), 2. / (z + 3.)}};
+  }
+  return g;
+}
+
+TEST(SymmetricBlockGf, Detection) {
+  auto g   = make_g(1);
+  auto h   = make_g(2);
+  auto B   = block_gf<imfreq>{{"up", "dn", "c", "t", "h", "ct"}, {g, g, conj(g), g, h, g}};
+  auto &gt = B[3];
+  for (auto const &w : g.mesh()) {
+    matrix<dcomplex> m = g[w];
+    gt[w]              = m.transpose();
+    B[5][w]            = conj(m.transpose());
+  }
+
+  auto S = symmetric_block_gf<imfreq>{B};
+  EXPECT_EQ(S.size(), 6);
+  EXPECT_EQ(S.n_unique(), 2);
+  auto const &s = S.symmetries();
+  EXPECT_EQ(s[0], (block_symmetry{0, block_op::identity}));
+  EXPECT_EQ(s[1], (block_symmetry{0, block_op::identity}));
+  EXPECT_EQ(s[2], (block_symmetry{0, block_op::conjugate}));
+  EXPECT_EQ(s[3], (block_symmetry{0, block_op::transpose}));
+  EXPECT_EQ(s[4], (block_symmetry{1, block_op::identity}));
+  EXPECT_EQ(s[5], (block_symmetry{0, block_op::conjugate_transpose}));
+  EXPECT_BLOCK_GF_NEAR(B, S.to_block_gf());
+
+  // modifying a unique block changes its images
+  S.unique_blocks()[0].data() *= 2;
+  EXPECT_GF_NEAR(S.block(1), S.unique_blocks()[0]);
+  EXPECT_GF_NEAR(S.block(2), gf<imfreq>{2. * conj(g)});
+
+  // h5 : unique blocks only
+  EXPECT_BLOCK_GF_NEAR(S.to_block_gf(), rw_h5(S, "sym_block" + std::to_string(world.rank()), "S").to_block_gf());
+}
+
+TEST(SymmetricBlockGf, Arithmetic) {
+  auto g = make_g(1);
+  auto S = symmetric_block_gf<imfreq>{block_gf<imfreq>{{"up", "dn", "c"}, {g, g, conj(g)}}};
+  auto B = S.to_block_gf();
+
+  auto S2 = S + S * 3.0;
+  block_gf<imfreq> B2 = B + B * 3.0;
+  EXPECT_BLOCK_GF_NEAR(S2.to_block_gf(), B2);
+  S2 -= S;
+  S2 /= 3.0;
+  EXPECT_BLOCK_GF_NEAR(S2.to_block_gf(), B);
+
+  // the conjugation does not commute with a complex factor
+  EXPECT_THROW(S *= 1_j, triqs::runtime_error);
+  S *= dcomplex(2, 0);
+
+  // different symmetries
+  auto T = symmetric_block_gf<imfreq>{block_gf<imfreq>{{"up", "dn", "c"}, {g, make_g(2), g}}};
+  EXPECT_THROW(S += T, triqs::runtime_error);
+}
+
+TEST(SymmetricBlockGf, Block2Zero) {
+  auto g  = make_g(1);
+  auto z  = gf<imfreq>{g.mesh(), {2, 2}};
+  z.data() = 0;
+  auto B  = block2_gf<imfreq>{{{"a", "b", "c"}, {"a", "b", "c"}}, {{g, z, z}, {z, g, z}, {z, z, conj(g)}}};
+
+  auto S = symmetric_block2_gf<imfreq>{B};
+  EXPECT_EQ(S.size(), 9);
+  EXPECT_EQ(S.n_unique(), 1);
+  EXPECT_EQ(S.symmetries()[1].op, block_op::zero);
+  EXPECT_EQ(S.symmetries()[8].op, block_op::conjugate);
+  EXPECT_GF_NEAR(S.block(0, 1), z);
+  EXPECT_BLOCK2_GF_NEAR(B, S.to_block_gf());
+  EXPECT_BLOCK2_GF_NEAR(B, rw_h5(S, "sym_block2_" + std::to_string(world.rank()), "S").to_block_gf());
+}
+
+TEST(SymmetricBlockGf, Explicit) {
+  auto g = make_g(1);
+  using s_t = symmetric_block_gf<imfreq>;
+  auto S  = s_t{{"up", "dn"}, {g}, {{0, block_op::identity}, {0, block_op::conjugate}}};
+  EXPECT_GF_NEAR(S.block(1), conj(g));
+
+  EXPECT_THROW((s_t{{"up", "dn"}, {g}, {{0, block_op::identity}}}), triqs::runtime_error);
+  EXPECT_THROW((s_t{{"up", "dn"}, {g}, {{0, block_op::identity}, {1, block_op::identity}}}), triqs::runtime_error);
+  EXPECT_THROW((s_t{{"up", "dn"}, {g}, {{0, block_op::identity}, {0, block_op::zero}}}), triqs::runtime_error);
+  auto Z = s_t{{"up", "dn"}, {g}, {{0, block_op::identity}, {0, block_op::zero}}, std::pair{g.mesh(), g.target_shape()}};
+  EXPECT_EQ(max_element(abs(Z.block(1).data())), 0);
+}
+
+TEST(SymmetricBlockGf, Mpi) {
+  auto g = make_g(1);
+  auto S = symmetric_block_gf<imfreq>{block_gf<imfreq>{{"up", "dn"}, {g, g}}};
+  mpi::all_reduce_in_place(S, world);
+  EXPECT_GF_NEAR(S.block(1), gf<imfreq>{double(world.size()) * g});
+
+  // packed with other objects
+  auto S2 = symmetric_block_gf<imfreq>{block_gf<imfreq>{{"up", "dn"}, {g, g}}};
+  double x = 1;
+  triqs::mc_tools::fused_reduction r;
+  r.add(S2);
+  r.add(x);
+  r.all_reduce(world);
+  EXPECT_GF_NEAR(S2.block(0), gf<imfreq>{double(world.size()) * g});
+  EXPECT_EQ(x, world.size());
+}
+
+MAKE_MAIN;
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/gfs.hpp>
+#include <triqs/h5/async_writer.hpp>
+
+namespace h5 = triqs::h5;
+using namespace triqs::gfs;
+using namespace triqs::arrays;
+triqs::clef::placeholder<0> iw_;
+
+TEST(H5AsyncWriter, Write) {
+  auto g = gf<imfreq>{{10, Fermion, 100}, {2, 2}};
+  g[iw_] << 1 / (iw_ + 2);
+  array<double, 2> A(300, 300);
+  A() = 3;
+  std::vector<double> v{1, 2, 3};
+
+  {
+    h5::file file("async_writer.h5", 'w');
+    h5::async_writer w{h5::group{file}, 2};
+    for (int n = 0; n < 5; ++n) {
+      w.write("g" + std::to_string(n), g());
+      w.write("A" + std::to_string(n), A);
+      g.data() *= 2; // the copy taken by write is not affected
+      A() += 1;
+    }
+    w.write("v", std::move(v));
+    w.write("x", 2.5);
+    w.flush();
+    EXPECT_EQ(w.n_pending(), 0);
+  }
+
+  h5::file file("async_writer.h5", 'r');
+  h5::group top(file);
+  auto g0 = gf<imfreq>{{10, Fermion, 100}, {2, 2}};
+  g0[iw_] << 1 / (iw_ + 2);
+  for (int n = 0; n < 5; ++n) {
+    gf<imfreq> gr;
+    array<double, 2> Ar;
+    h5_read(top, "g" + std::to_string(n), gr);
+    h5_read(top, "A" + std::to_string(n), Ar);
+    EXPECT_GF_NEAR(gr, g0);
+    EXPECT_EQ(Ar(7, 9), 3 + n);
+    g0.data() *= 2;
+  }
+  std::vector<double> vr;
+  h5_read(top, "v", vr);
+  EXPECT_EQ(vr, (std::vector<double>{1, 2, 3}));
+  EXPECT_EQ(h5::h5_read<double>(top, "x"), 2.5);
+}
+
+TEST(H5AsyncWriter, Error) {
+  h5::file file("async_writer2.h5", 'w');
+  h5::async_writer w{h5::group{file}};
+  w.write("no_such_group/x", 1.0);
+  EXPECT_THROW(
+     {
+       w.write("y", 2.0); // not done (the error is thrown here if the first write has already failed)
+       w.wait();
+     },
+     triqs::runtime_error);
+  w.write("z", 3.0); // the writer can be used again
+  w.wait();
+  EXPECT_FALSE(h5::group{file}.has_key("y"));
+  EXPECT_TRUE(h5::group{file}.has_key("z"));
+}
+
+MAKE_MAIN;
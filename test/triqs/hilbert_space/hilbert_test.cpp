@@ -6,6 +6,7 @@
 #include <triqs/hilbert_space/hilbert_space.hpp>
 #include <triqs/hilbert_space/imperative_operator.hpp>
 #include <triqs/hilbert_space/state.hpp>
+#include <triqs/hilbert_space/space_partition.hpp>
 
 using namespace triqs::hilbert_space;
 
@@ -214,4 +215,92 @@ TEST(hilbert_space, StateProjection) {
   check_state(proj_st, {{4, 0.3}, {6, 0.4}}); // projected state
 }
 
+TEST(hilbert_space, compiled_operator) {
+  fundamental_operator_set fops;
+  for (int i = 0; i < 3; ++i) fops.insert("up", i);
+  for (int i = 0; i < 3; ++i) fops.insert("dn", i);
+
+  using triqs::hilbert_space::hilbert_space;
+  hilbert_space hs(fops);
+
+  using triqs::operators::c;
+  using triqs::operators::c_dag;
+  using triqs::operators::n;
+  auto H = 2.0 * n("up", 0) * n("dn", 0) - 0.5 * n("up", 1) + 0.3 * c_dag("up", 0) * c("up", 2) + 0.3 * c_dag("up", 2) * c("up", 0) +
+     0.7 * c_dag("up", 1) * c_dag("dn", 2) * c("dn", 1) * c("up", 2) + 0.1 * c("dn", 0);
+
+  auto opH  = imperative_operator<hilbert_space>(H, fops);
+  auto cmpH = opH.compile(hs, hs);
+  EXPECT_EQ(hs.size(), cmpH.n_rows());
+  EXPECT_EQ(hs.size(), cmpH.n_cols());
+
+  // State by state, and as a batch
+  using state_t = state<hilbert_space, double, false>;
+  triqs::arrays::matrix<double> batch(hs.size(), 5);
+  for (int b = 0; b < 5; ++b) {
+    state_t st(hs);
+    for (int i = 0; i < hs.size(); ++i) st(i) = std::cos(0.1 * i * (b + 1));
+    batch(triqs::arrays::range(), b) = st.amplitudes();
+    auto ref = opH(st);
+    EXPECT_ARRAY_NEAR(ref.amplitudes(), cmpH(st).amplitudes());
+    // map-based state
+    state<hilbert_space, double, true> st_map(hs);
+    st_map(3) = 1.0;
+    check_state(cmpH(st_map), [&] {
+      std::map<int, double> m;
+      foreach (opH(st_map), [&](int i, double a) { m[i] = a; })
+        ;
+      return m;
+    }());
+  }
+  auto res = cmpH.apply_batch(batch);
+  for (int b = 0; b < 5; ++b) {
+    state_t st(hs);
+    st.amplitudes() = batch(triqs::arrays::range(), b);
+    EXPECT_ARRAY_NEAR(opH(st).amplitudes(), res(triqs::arrays::range(), b));
+  }
+
+  // As the operator of space_partition
+  state_t st0(hs);
+  space_partition<state_t, imperative_operator<hilbert_space>> sp_ref(st0, opH);
+  space_partition<state_t, compiled_operator<hilbert_space>> sp(st0, cmpH);
+  EXPECT_EQ(sp_ref.n_subspaces(), sp.n_subspaces());
+  EXPECT_EQ(sp_ref.get_matrix_elements(), sp.get_matrix_elements());
+}
+
+TEST(hilbert_space, compiled_operator_sub_hilbert_space) {
+  using triqs::operators::c_dag;
+  auto Cdag = c_dag("up", 2) + 0.5 * c_dag("up", 0);
+
+  fundamental_operator_set fop;
+  for (int i = 0; i < 3; ++i) fop.insert("up", i);
+
+  // Subspaces with 1 and 2 particles
+  sub_hilbert_space phs1(0), phs2(1);
+  for (fock_state_t f = 0; f < 8; ++f) {
+    if (__builtin_popcount(f) == 1) phs1.add_fock_state(f);
+    if (__builtin_popcount(f) == 2) phs2.add_fock_state(f);
+  }
+
+  std::vector<sub_hilbert_space> sub{phs1, phs2};
+  std::vector<int> Cdagmap{1, -1};
+  auto opCdag  = imperative_operator<sub_hilbert_space, double, true>(Cdag, fop, Cdagmap, &sub);
+  auto cmpCdag = opCdag.compile(sub[0]);
+  EXPECT_EQ(3, cmpCdag.n_rows());
+  EXPECT_EQ(3, cmpCdag.n_cols());
+  EXPECT_EQ(4, cmpCdag.n_nonzeros());
+
+  state<sub_hilbert_space, double, false> start(sub[0]);
+  start(0) = 1.0;
+  start(1) = 2.0;
+  start(2) = 3.0;
+  auto ref = opCdag(start);
+  auto res = cmpCdag(start);
+  EXPECT_EQ(&ref.get_hilbert(), &res.get_hilbert());
+  EXPECT_ARRAY_NEAR(ref.amplitudes(), res.amplitudes());
+
+  // Nothing is connected to the 2-particle subspace
+  EXPECT_EQ(0, opCdag.compile(sub[1]).n_nonzeros());
+}
+
 MAKE_MAIN;
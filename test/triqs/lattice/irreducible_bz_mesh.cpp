@@ -0,0 +1,76 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/lattice/irreducible_bz_mesh.hpp>
+
+using namespace triqs::lattice;
+
+TEST(IrreducibleBzMesh, PointGroup) {
+  EXPECT_EQ(point_group(bravais_lattice{make_unit_matrix<double>(1)}).size(), 2);
+  EXPECT_EQ(point_group(bravais_lattice{make_unit_matrix<double>(2)}).size(), 8);
+  EXPECT_EQ(point_group(bravais_lattice{make_unit_matrix<double>(3)}).size(), 48);
+  EXPECT_EQ(point_group(bravais_lattice{matrix<double>{{1., 0.}, {0.5, std::sqrt(3.) / 2}}}).size(), 12);
+  EXPECT_EQ(point_group(bravais_lattice{matrix<double>{{1., 0.}, {0., 2.}}}).size(), 4);
+  EXPECT_ARRAY_NEAR(point_group(bravais_lattice{make_unit_matrix<double>(3)})[0], make_unit_matrix<double>(3));
+}
+
+// Check the maps and weights of the wedge of a mesh, with a function invariant under the group
+template <typename F> void check_wedge(gf_mesh<brillouin_zone> const &m, long n_irr, F f) {
+  auto w = irreducible_bz_mesh{m};
+  EXPECT_EQ(w.size(), n_irr);
+
+  double s = 0;
+  for (auto x : w.weights()) s += x;
+  EXPECT_NEAR(s, 1, 1.e-12);
+
+  auto g = gf<brillouin_zone, scalar_valued>{m};
+  for (auto const &k : m) g[k] = f(k);
+
+  // each point is the image of its irreducible point
+  for (auto const &k : m) {
+    long l   = k.linear_index();
+    long irr = w.full_to_irreducible(l);
+    EXPECT_EQ(w.full_to_irreducible(k.index()), irr);
+    auto gk = w.operations()[w.op_index(l)] * w.k(irr);
+    EXPECT_NEAR(f(gk), f(k), 1.e-10);
+  }
+  for (long i = 0; i < w.size(); ++i) EXPECT_EQ(w.full_to_irreducible(w.irreducible_to_full(i)), i);
+
+  // reduce, unfold and sum
+  auto irr = w.reduce(g());
+  EXPECT_EQ(irr.shape()[0], n_irr);
+  EXPECT_ARRAY_NEAR(w.unfold(irr), g.data());
+  EXPECT_GF_NEAR(w.unfold_gf<scalar_valued>(irr), g);
+  dcomplex sum = 0;
+  for (auto const &k : m) sum += g[k];
+  EXPECT_COMPLEX_NEAR(w.k_sum(irr), sum / double(m.size()), 1.e-12);
+}
+
+TEST(IrreducibleBzMesh, Square) {
+  auto bz = brillouin_zone{bravais_lattice{make_unit_matrix<double>(2)}};
+  auto f  = [](auto const &k) { return std::cos(k(0)) + std::cos(k(1)) + 0.3 * std::cos(k(0)) * std::cos(k(1)); };
+  // (n/2 + 1)(n/2 + 2)/2 irreducible points for n even
+  check_wedge(gf_mesh<brillouin_zone>{bz, 8}, 15, f);
+  check_wedge(gf_mesh<brillouin_zone>{bz, 6}, 10, f);
+}
+
+TEST(IrreducibleBzMesh, Cubic) {
+  auto bz = brillouin_zone{bravais_lattice{make_unit_matrix<double>(3)}};
+  auto f  = [](auto const &k) { return std::cos(k(0)) + std::cos(k(1)) + std::cos(k(2)); };
+  check_wedge(gf_mesh<brillouin_zone>{bz, 8}, 35, f);
+}
+
+TEST(IrreducibleBzMesh, Matrix) {
+  auto bz = brillouin_zone{bravais_lattice{make_unit_matrix<double>(2)}};
+  auto m  = gf_mesh<brillouin_zone>{bz, 6};
+  auto w  = irreducible_bz_mesh{m};
+  auto g  = gf<brillouin_zone>{m, {2, 2}};
+  for (auto const &k : m) g[k] = (std::cos(k(0)) + std::cos(k(1))) * matrix<double>{{1., 0.5}, {0.5, 2.}};
+  auto irr = w.reduce(g());
+  EXPECT_GF_NEAR(w.unfold_gf(irr), g);
+  EXPECT_ARRAY_NEAR(w.k_sum(irr), matrix<double>{{0., 0.}, {0., 0.}}, 1.e-12);
+  EXPECT_THROW(w.reduce(gf<brillouin_zone>{gf_mesh<brillouin_zone>{bz, 4}, {2, 2}}), triqs::runtime_error);
+
+  // h5
+  EXPECT_TRUE(w == rw_h5(w, "irr_bz_mesh", "w"));
+}
+
+MAKE_MAIN;
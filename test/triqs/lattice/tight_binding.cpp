@@ -24,6 +24,8 @@
 #include <triqs/test_tools/gfs.hpp>
 
 #include <triqs/lattice/tight_binding.hpp>
+#include <triqs/lattice/grid_generator.hpp>
+#include <triqs/arrays/linalg/eigenelements.hpp>
 
 #include <vector>
 
@@ -55,4 +57,42 @@ TEST(tight_binding, h5_read_write) {
   }
 }
 
+// A two-band square lattice, with a hopping longer than the k-mesh to check the folding
+tight_binding make_two_band_tb() {
+  auto bl = bravais_lattice{matrix<double>{{1, 0}, {0, 1}}, std::vector<r_t>{r_t{0., 0., 0.}, r_t{0.5, 0.5, 0.}}};
+  auto t1 = matrix<dcomplex>{{-1.0, 0.2}, {0.2, -0.5}};
+  auto t2 = matrix<dcomplex>{{0.1 + 0_j, 0.3_j}, {-0.3_j, 0.0 + 0_j}};
+  auto displ_vec       = std::vector<std::vector<long>>{{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {5, 1}, {-5, -1}};
+  auto overlap_mat_vec = std::vector<matrix<dcomplex>>{t1, t1, t1, t1, t2, dagger(t2)};
+  return tight_binding{bl, displ_vec, overlap_mat_vec};
+}
+
+TEST(tight_binding, energy_matrix_on_bz_mesh) {
+  auto tb = make_two_band_tb();
+  auto TK = fourier(tb);
+
+  int n_k     = 4;
+  auto k_mesh = gf_mesh<brillouin_zone>{brillouin_zone{tb.lattice()}, n_k};
+  auto hk     = energy_matrix_on_bz_mesh(tb, k_mesh);
+
+  for (auto const &k : k_mesh) {
+    auto n = k.index();
+    // fourier(tb) takes k in units of the reciprocal vectors
+    auto k_frac = arrays::vector<double>{double(n[0]) / n_k, double(n[1]) / n_k, 0.};
+    EXPECT_ARRAY_NEAR(matrix<dcomplex>{hk[k]}, TK(k_frac), 1.e-12);
+  }
+}
+
+TEST(tight_binding, energies_on_bz_grid) {
+  auto tb = make_two_band_tb();
+  auto TK = fourier(tb);
+
+  int n_k   = 6;
+  auto eval = energies_on_bz_grid(tb, n_k);
+
+  grid_generator grid(tb.lattice().dim(), n_k);
+  EXPECT_EQ(eval.shape(1), grid.size());
+  for (; grid; ++grid) EXPECT_ARRAY_NEAR(eval(range(), grid.index()), linalg::eigenvalues(TK((*grid)(range(0, 2)))()), 1.e-12);
+}
+
 MAKE_MAIN;
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools.hpp>
+
+using namespace triqs::arrays;
+using triqs::mc_tools::random_generator;
+
+mpi::communicator world;
+
+// A random walk of x
+struct move_walk {
+  double &x;
+  random_generator &rng;
+  double old = 0;
+  double attempt() {
+    old = x;
+    x += rng(-1.0, 1.0);
+    return std::exp(-x * x / 10) / std::exp(-old * old / 10);
+  }
+  double accept() { return 1; }
+  void reject() { x = old; }
+};
+
+// Accumulates the powers of x, and a hash of the sequence of the x (which depends on the order of the accumulation)
+struct measure_powers {
+  double const &x;
+  int power;
+  array<double, 1> &result;
+  array<double, 1> acc = zeros<double>(2);
+
+  void add(double y, double s) {
+    acc(0) += s * std::pow(y, power);
+    acc(1) = std::fmod(acc(1) * 1.000001 + y, 1.e6);
+  }
+  void accumulate(double s) { add(x, s); }
+  auto snapshot(double s) {
+    return [this, y = x, s]() { add(y, s); };
+  }
+  void collect_results(mpi::communicator const &) { result = acc; }
+};
+
+// Serial only
+struct measure_count {
+  long &result;
+  long count = 0;
+  void accumulate(double) { ++count; }
+  void collect_results(mpi::communicator const &) { result = count; }
+};
+
+static_assert(triqs::mc_tools::has_snapshot<double, measure_powers>::value);
+static_assert(!triqs::mc_tools::has_snapshot<double, measure_count>::value);
+
+// Run with n_threads workers, return the results of all measures
+std::vector<array<double, 1>> run(int n_threads, long &n) {
+  triqs::mc_tools::mc_generic<double> mc("", 12, 0);
+  double x = 0;
+  mc.add_move(move_walk{x, mc.get_rng()}, "walk");
+  std::vector<array<double, 1>> res(4);
+  for (int p = 0; p < 4; ++p) mc.add_measure(measure_powers{x, p + 1, res[p]}, "power " + std::to_string(p));
+  mc.add_measure(measure_count{n}, "count");
+  mc.set_measure_threads(n_threads, 4);
+  mc.warmup_and_accumulate(10, 2000, 5, triqs::utility::clock_callback(-1));
+  mc.collect_results(world);
+  return res;
+}
+
+TEST(McGeneric, AsyncMeasures) {
+  long n0 = 0, n2 = 0, n3 = 0;
+  auto r0 = run(0, n0);
+  auto r2 = run(2, n2);
+  auto r3 = run(3, n3);
+  EXPECT_EQ(n0, 2000);
+  EXPECT_EQ(n2, 2000);
+  EXPECT_EQ(n3, 2000);
+  for (int p = 0; p < 4; ++p) {
+    EXPECT_ARRAY_EQ(r0[p], r2[p]);
+    EXPECT_ARRAY_EQ(r0[p], r3[p]);
+  }
+}
+
+// An exception in an asynchronous measure is rethrown on the Monte Carlo thread
+struct measure_throw {
+  long count = 0;
+  void accumulate(double) {}
+  auto snapshot(double) {
+    return [this]() {
+      if (++count == 10) TRIQS_RUNTIME_ERROR << "measure_throw";
+    };
+  }
+  void collect_results(mpi::communicator const &) {}
+};
+
+TEST(McGeneric, AsyncMeasuresException) {
+  triqs::mc_tools::mc_generic<double> mc("", 12, 0);
+  double x = 0;
+  mc.add_move(move_walk{x, mc.get_rng()}, "walk");
+  mc.add_measure(measure_throw{}, "throw");
+  mc.set_measure_threads(1);
+  EXPECT_THROW(mc.warmup_and_accumulate(0, 100, 1, triqs::utility::clock_callback(-1)), triqs::runtime_error);
+}
+
+TEST(SpscQueue, Order) {
+  triqs::mc_tools::spsc_queue<long> q(3);
+  long n = 10000, sum = 0, expected = 0;
+  bool ordered = true;
+  std::thread consumer([&]() {
+    long x;
+    for (long i = 0; i < n;) {
+      if (q.try_pop(x)) {
+        ordered = ordered and (x == i);
+        sum += x;
+        ++i;
+      } else
+        std::this_thread::yield();
+    }
+  });
+  for (long i = 0; i < n; ++i) {
+    q.push(i);
+    expected += i;
+  }
+  consumer.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(sum, expected);
+  EXPECT_TRUE(q.empty());
+}
+
+MAKE_MAIN;
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools.hpp>
+#include <chrono>
+#include <thread>
+
+mpi::communicator world;
+
+// The cost of a cycle depends on the node
+struct move_slow {
+  int delay_us;
+  double attempt() {
+    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+    return 1;
+  }
+  double accept() { return 1; }
+  void reject() {}
+};
+
+struct count_cycles {
+  long &n;
+  void accumulate(double) { ++n; }
+  void collect_results(mpi::communicator const &) {}
+};
+
+TEST(McGeneric, CooperativeStop) {
+  triqs::mc_tools::mc_generic<double> mc("", 1, 0);
+  mc.add_move(move_slow{50 * (1 + 4 * world.rank())}, "slow");
+  long n = 0;
+  mc.add_measure(count_cycles{n}, "count");
+  mc.set_cooperative_stop(world, 0.01);
+
+  int status = mc.accumulate(200, 1, triqs::utility::clock_callback(-1));
+  EXPECT_EQ(status, 0);
+  EXPECT_LE(mc.get_percent(), 100);
+
+  // the total number of cycles is reached, the fast nodes having done more of them
+  long n_tot = mpi::all_reduce(n, world);
+  EXPECT_GE(n_tot, 200 * world.size());
+  if (world.size() > 1) {
+    EXPECT_GT(mpi::all_reduce(n, world, 0, MPI_MAX), 200);
+  }
+
+  // all nodes stop when one of them asks to
+  n          = 0;
+  int stop_n = 20;
+  status     = mc.accumulate(1000000, 1, [&]() { return world.rank() == 0 and n >= stop_n; });
+  EXPECT_EQ(status, 1);
+  EXPECT_LT(mpi::all_reduce(n, world), 1000000 * world.size());
+}
+
+// The warmup is not cooperative : each node does all its cycles
+TEST(McGeneric, CooperativeStopWarmup) {
+  triqs::mc_tools::mc_generic<double> mc("", 1, 0);
+  mc.add_move(move_slow{50 * (1 + 4 * world.rank())}, "slow");
+  long n = 0;
+  mc.set_after_cycle_duty([&n]() { ++n; });
+  mc.set_cooperative_stop(world, 0.01);
+  EXPECT_EQ(mc.warmup(100, 1, triqs::utility::clock_callback(-1)), 0);
+  EXPECT_EQ(n, 100);
+}
+
+MAKE_MAIN;
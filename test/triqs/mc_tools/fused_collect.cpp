@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include <triqs/test_tools/arrays.hpp>
+#include <triqs/mc_tools.hpp>
+
+using namespace triqs::arrays;
+using triqs::mc_tools::fused_reduction;
+
+mpi::communicator world;
+
+// Always accepted
+struct move_trivial {
+  double attempt() { return 1; }
+  double accept() { return 1; }
+  void reject() {}
+};
+
+// Two-phase measure : sum of the sign, a count, an histogram and moments, reduced together with the other fused measures
+struct measure_fused {
+  double &result;
+  array<dcomplex, 1> &histo;
+  double z   = 0;
+  long count = 0;
+  array<dcomplex, 1> h;
+  std::vector<double> moments = {0, 0};
+  std::vector<double> *moments_result = nullptr;
+  measure_fused(double &result, array<dcomplex, 1> &histo) : result(result), histo(histo), h(3) { h() = 0; }
+
+  void accumulate(double s) {
+    z += s;
+    h(count % 3) += dcomplex{1, -1};
+    moments[0] += s;
+    moments[1] += s * s;
+    ++count;
+  }
+  void register_accumulators(fused_reduction &r) {
+    r.add(z);
+    r.add(count);
+    r.add(h);
+    r.add(moments);
+  }
+  void finalize_results(mpi::communicator const &) {
+    result = z / count;
+    histo  = h;
+    if (moments_result) *moments_result = moments;
+  }
+};
+
+// Classic measure
+struct measure_classic {
+  long &result;
+  long count = 0;
+  void accumulate(double) { ++count; }
+  void collect_results(mpi::communicator const &c) { result = mpi::all_reduce(count, c); }
+};
+
+TEST(McGeneric, FusedCollect) {
+  triqs::mc_tools::mc_generic<double> mc("", 1, 0);
+  mc.add_move(move_trivial{}, "trivial");
+
+  double r1 = 0, r2 = 0;
+  long n    = 0;
+  array<dcomplex, 1> h1, h2;
+  std::vector<double> m1;
+  auto f1           = measure_fused{r1, h1};
+  f1.moments_result = &m1;
+  mc.add_measure(std::move(f1), "fused 1");
+  mc.add_measure(measure_classic{n}, "classic");
+  mc.add_measure(measure_fused{r2, h2}, "fused 2");
+
+  mc.warmup_and_accumulate(0, 30, 1, triqs::utility::clock_callback(-1));
+  mc.collect_results(world);
+
+  EXPECT_EQ(n, 30 * world.size());
+  EXPECT_NEAR(r1, 1, 1e-14);
+  EXPECT_NEAR(r2, 1, 1e-14);
+  array<dcomplex, 1> h = {10, 10, 10};
+  EXPECT_ARRAY_NEAR(h1, world.size() * h * dcomplex{1, -1});
+  EXPECT_ARRAY_NEAR(h2, h1);
+  EXPECT_EQ(m1, (std::vector<double>{30. * world.size(), 30. * world.size()}));
+  EXPECT_EQ(mc.get_acceptance_rates()["trivial"], 1.0);
+}
+
+MAKE_MAIN;
@@ -237,4 +237,43 @@ TEST(Operator, RealOrComplex) {
   EXPECT_EQ(fs.data(), fs2.data());
 }
 
+TEST(Operator, IndicesOrdering) {
+  // The order of the canonical operators must not depend on the order in which their indices were first seen
+  auto x = c_dag("z", 7) * c_dag("a", 100) * c_dag("m", -3) * c_dag(5) * c(-2);
+  EXPECT_PRINT("-1*c_dag(5)*c_dag('a',100)*c_dag('m',-3)*c_dag('z',7)*c(-2)", x);
+
+  // Squeeze many new indices between two known ones
+  auto N = many_body_operator{};
+  for (int i = 0; i < 100; ++i) N += n("s", 1000 - 10 * i) + n("s", 1000 - 10 * i - 5);
+  auto first_terms = std::string{"1*c_dag('s',5)*c('s',5) + 1*c_dag('s',10)*c('s',10) + 1*c_dag('s',15)*c('s',15)"};
+  std::stringstream ss;
+  ss << N;
+  EXPECT_EQ(ss.str().substr(0, first_terms.size()), first_terms);
+
+  // (sum_i n_i)^2 = sum_i n_i + 2 sum_{i<j} n_i n_j
+  auto M = n(0, "up") + n(0, "dn") + n(1, "up") + n(1, "dn");
+  auto R = M;
+  std::vector<many_body_operator> ns = {n(0, "up"), n(0, "dn"), n(1, "up"), n(1, "dn")};
+  for (int i = 0; i < 4; ++i)
+    for (int j = i + 1; j < 4; ++j) R += 2 * ns[i] * ns[j];
+  EXPECT_TRUE((M * M - R).is_zero());
+}
+
+TEST(Operator, HashStoreIteration) {
+  // The terms are stored in a hash map, but iterated in the order of the monomials
+  auto H = n("up", 1) + 2.0 * c_dag("dn", 0) * c("up", 0) + 3.0;
+  EXPECT_PRINT("3 + 2*c_dag('dn',0)*c('up',0) + 1*c_dag('up',1)*c('up',1)", H);
+  auto last = H.end();
+  --last;
+  EXPECT_EQ((*last).monomial[0].indices, (indices_t{"up", 1}));
+
+  // a modification after an iteration, and a copy, sort the terms again
+  auto H2 = H;
+  H += c_dag("a", 0) * c("a", 0);
+  EXPECT_PRINT("3 + 1*c_dag('a',0)*c('a',0) + 2*c_dag('dn',0)*c('up',0) + 1*c_dag('up',1)*c('up',1)", H);
+  EXPECT_PRINT("3 + 2*c_dag('dn',0)*c('up',0) + 1*c_dag('up',1)*c('up',1)", H2);
+  H = H2;
+  EXPECT_EQ(std::distance(H.begin(), H.end()), 3);
+}
+
 MAKE_MAIN;
@@ -0,0 +1,100 @@
+#include <triqs/test_tools/gfs.hpp>
+#include <triqs/utility/binary_serialization.hpp>
+#include <triqs/operators/many_body_operator.hpp>
+#include <triqs/statistics/histograms.hpp>
+
+using namespace triqs::utility;
+
+template <typename T> T round_trip(T const &x) { return binary_deserialize<T>(binary_serialize(x)); }
+
+TEST(BinarySerialization, Basic) {
+  EXPECT_EQ(127.5, round_trip(127.5));
+  EXPECT_EQ(dcomplex(1, 2), round_trip(dcomplex(1, 2)));
+
+  auto v = std::vector<std::string>{"abc", "3", ""};
+  EXPECT_EQ(v, round_trip(v));
+
+  auto m = std::map<std::string, std::vector<double>>{{"a", {1, 2}}, {"b", {}}};
+  EXPECT_EQ(m, round_trip(m));
+
+  auto t = std::make_tuple(1, std::string{"x"}, std::optional<long>{3}, std::optional<long>{});
+  EXPECT_EQ(t, round_trip(t));
+
+  using var_t = std::vector<std::variant<int, std::string>>;
+  auto va     = var_t{1, std::string{"up"}, 3};
+  auto va2    = round_trip(va);
+  EXPECT_EQ(std::get<std::string>(va2[1]), "up");
+  EXPECT_EQ(std::get<int>(va2[2]), 3);
+
+  // Not an archive
+  std::vector<char> junk(20, 'a');
+  EXPECT_THROW(binary_deserialize<double>(junk), triqs::runtime_error);
+  // Truncated
+  auto s = binary_serialize(v);
+  s.resize(s.size() - 1);
+  EXPECT_THROW(binary_deserialize<std::vector<std::string>>(s), triqs::runtime_error);
+}
+
+TEST(BinarySerialization, Arrays) {
+  array<dcomplex, 3> a(4, 5, 6);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 5; ++j)
+      for (int k = 0; k < 6; ++k) a(i, j, k) = dcomplex(i + 10 * j, k);
+
+  auto s = binary_serialize(a);
+  // The header, the shape, and the numbers : nothing else
+  EXPECT_EQ(s.size(), 8 + 3 * 8 + a.size() * sizeof(dcomplex));
+  EXPECT_ARRAY_NEAR(a, round_trip(a));
+
+  // Fortran layout and non contiguous views are written in C order
+  array<dcomplex, 3> af(a, FORTRAN_LAYOUT);
+  EXPECT_EQ(binary_serialize(af), s);
+  auto v = a(range(1, 3), range(), 2);
+  EXPECT_ARRAY_NEAR(v, binary_deserialize<array<dcomplex, 2>>(binary_serialize(v)));
+
+  // into a view of the same shape
+  array<dcomplex, 3> b(4, 5, 6);
+  b() = 0;
+  binary_iarchive ar{s.data(), s.size()};
+  auto bv = b();
+  ar &bv;
+  EXPECT_ARRAY_NEAR(a, b);
+}
+
+TEST(BinarySerialization, Gf) {
+  double beta = 10;
+  auto g      = gf<imfreq>{{beta, Fermion, 100}, {2, 2}};
+  g[0]        = 1;
+  g[3]        = matrix<dcomplex>{{1, 2}, {3, 4}};
+  auto g2     = round_trip(g);
+  EXPECT_GF_NEAR(g, g2);
+  EXPECT_EQ(g.mesh(), g2.mesh());
+
+  auto gt = gf<imtime, scalar_real_valued>{{beta, Boson, 50}};
+  for (auto t : gt.mesh()) gt[t] = double(t);
+  EXPECT_GF_NEAR(gt, round_trip(gt));
+
+  auto B  = make_block_gf({"up", "dn"}, std::vector<gf<imfreq>>{g, 2 * g});
+  auto B2 = round_trip(B);
+  EXPECT_EQ(B.block_names(), B2.block_names());
+  EXPECT_BLOCK_GF_NEAR(B, B2);
+
+  // Little more than the data
+  EXPECT_LT(binary_serialize(g).size(), g.data().size() * sizeof(dcomplex) + 200);
+}
+
+TEST(BinarySerialization, OperatorsAndHistograms) {
+  using namespace triqs::operators;
+  auto H  = -0.5 * n("up", 0) * n("dn", 0) + c_dag("up", 0) * c("dn", 1) + 2.0;
+  auto H2 = round_trip(H);
+  EXPECT_TRUE(H2 == H);
+
+  triqs::statistics::histogram h{0, 10};
+  h << 1 << 3 << 3 << 12;
+  auto h2 = round_trip(h);
+  EXPECT_EQ(h.data(), h2.data());
+  EXPECT_EQ(h.n_data_pts(), h2.n_data_pts());
+  EXPECT_EQ(h.n_lost_pts(), h2.n_lost_pts());
+}
+
+MAKE_MAIN;
@@ -37,6 +37,7 @@
 // HDF5 interface
 #include <triqs/arrays/h5/simple_read_write.hpp>
 #include <triqs/arrays/h5/array_of_non_basic.hpp>
+#include <triqs/arrays/h5/mapped_array.hpp>
 
 // proxy
 #include <triqs/arrays/proxy.hxx>
@@ -51,6 +52,7 @@
 #include <triqs/arrays/linalg/det_and_inverse.hpp>
 
 #include <triqs/arrays/mpi.hpp>
+#include <triqs/arrays/mpi_shared.hpp>
 
 // immutable_array
 #include <triqs/arrays/make_immutable_array.hpp>
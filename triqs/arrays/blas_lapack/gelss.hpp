@@ -156,9 +156,13 @@ namespace triqs::arrays::lapack {
     std::pair<matrix<value_type>, double> operator()(matrix_const_view<value_type> B, std::optional<long> inner_matrix_dim = {} /*unused*/) const {
       double err = 0.0;
       if (M != N) {
-        std::vector<double> err_vec;
-        for (int i : range(B.shape()[1])) err_vec.push_back(frobenius_norm(UT_NULL * B(range(), range(i, i + 1))) / sqrt(B.shape()[0]));
-        err = *std::max_element(err_vec.begin(), err_vec.end());
+        // Residual of all the right-hand sides at once, then the largest norm over the columns
+        matrix<value_type> R = UT_NULL * B;
+        for (int i : range(second_dim(R))) {
+          double r2 = 0;
+          for (int j : range(first_dim(R))) r2 += std::norm(R(j, i));
+          err = std::max(err, std::sqrt(r2 / B.shape()[0]));
+        }
       }
       return std::make_pair(V_x_InvS_x_UT * B, err);
     }
@@ -27,6 +27,7 @@
 #include "f77/cxx_interface.hpp"
 #include "tools.hpp"
 #include "qcache.hpp"
+#include "small_matrix.hpp"
 
 namespace triqs::arrays::blas {
 
@@ -52,6 +53,15 @@ namespace triqs::arrays::blas {
     // first resize if necessary and possible
     resize_or_check_if_view(C, make_shape(first_dim(A), second_dim(B)));
 
+    // tiny matrices : the unrolled kernels are faster than the BLAS call and the caches
+    if constexpr (small_matrix::can_use<MT1, MT2, MTOut>()) {
+      if (small_matrix::are_small(A, B)) {
+        if (second_dim(A) != first_dim(B)) TRIQS_RUNTIME_ERROR << "Dimension mismatch in gemm : A : " << get_shape(A) << " while B : " << get_shape(B);
+        small_matrix::gemm(alpha, A, B, beta, C);
+        return;
+      }
+    }
+
     // now we use qcache instead of the matrix to make a copy if necessary ...
     // not optimal : if stride == 1, N ---> use LDA parameters
     // change the condition in the qcache construction....
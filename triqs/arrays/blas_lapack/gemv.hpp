@@ -25,6 +25,7 @@
 #include "f77/cxx_interface.hpp"
 #include "tools.hpp"
 #include "qcache.hpp"
+#include "small_matrix.hpp"
 
 namespace triqs::arrays::blas {
 
@@ -47,6 +48,13 @@ namespace triqs::arrays::blas {
                                                                           typename MT::value_type beta, VTOut &Y) {
     //std::cerr  << "gemm: blas call "<< std::endl ;
     resize_or_check_if_view(Y, make_shape(first_dim(A))); // first resize if necessary and possible
+    if constexpr (small_matrix::can_use<MT, VT, VTOut>()) { // tiny matrices, cf gemm
+      if (small_matrix::are_small(A)) {
+        if (second_dim(A) != X.size()) TRIQS_RUNTIME_ERROR << "Dimension mismatch in gemv : A : " << get_shape(A) << " while X : " << get_shape(X);
+        small_matrix::gemv(alpha, A, X, beta, Y);
+        return;
+      }
+    }
     const_qcache<MT> Ca(A);
     const_qcache<VT> Cx(X); // mettre la condition a la main
     if (!(second_dim(Ca()) == Cx().size()))
@@ -0,0 +1,203 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+
+#include <triqs/utility/exceptions.hpp>
+#include "tools.hpp"
+#include "../impl/traits.hpp"
+
+// Kernels for very small matrices (dimensions <= small_matrix::max_dim), used instead of
+// BLAS/LAPACK calls whose overhead (caches, Fortran call, workspace) dominates at these sizes.
+// They work on raw pointers and strides, with the inner dimension known at compile time
+// so that the loops are unrolled.
+namespace triqs::arrays::small_matrix {
+
+  constexpr int max_dim = 8;
+
+  // Are the operands value or view classes (not expressions) of a blas type, all small enough ?
+  template <typename... MT> constexpr bool can_use() {
+    return ((is_amv_value_or_view_class<std::decay_t<MT>>::value and is_blas_lapack_type<typename std::decay_t<MT>::value_type>::value) and ...)
+       and have_same_value_type<std::decay_t<MT>...>::value;
+  }
+
+  template <typename... MT> bool are_small(MT const &... x) {
+    auto small = [](auto const &a) {
+      auto const &l = a.indexmap().lengths();
+      for (int r = 0; r < l.size(); ++r)
+        if (l[r] > max_dim) return false;
+      return true;
+    };
+    return (small(x) and ...);
+  }
+
+  // C = alpha * A * B + beta * C, with A (m x K), B (K x n). C is not read if beta == 0
+  template <int K, typename T>
+  void gemm_k(int m, int n, T alpha, T const *a, long a0, long a1, T const *b, long b0, long b1, T beta, T *c, long c0, long c1) {
+    for (int i = 0; i < m; ++i)
+      for (int j = 0; j < n; ++j) {
+        T s = 0;
+        for (int k = 0; k < K; ++k) s += a[i * a0 + k * a1] * b[k * b0 + j * b1];
+        T &r = c[i * c0 + j * c1];
+        r    = (beta == T(0) ? alpha * s : alpha * s + beta * r);
+      }
+  }
+
+  template <typename MT1, typename MT2, typename MTOut>
+  void gemm(typename MT1::value_type alpha, MT1 const &A, MT2 const &B, typename MT1::value_type beta, MTOut &C) {
+    using T = typename MTOut::value_type;
+    auto m = first_dim(A), n = second_dim(B);
+    auto const &sa = A.indexmap().strides();
+    auto const &sb = B.indexmap().strides();
+    auto const &sc = C.indexmap().strides();
+    auto f         = [&](auto K) {
+      gemm_k<decltype(K)::value, T>(m, n, alpha, A.data_start(), sa[0], sa[1], B.data_start(), sb[0], sb[1], beta, C.data_start(), sc[0], sc[1]);
+    };
+    switch (second_dim(A)) {
+      case 0: f(std::integral_constant<int, 0>{}); return;
+      case 1: f(std::integral_constant<int, 1>{}); return;
+      case 2: f(std::integral_constant<int, 2>{}); return;
+      case 3: f(std::integral_constant<int, 3>{}); return;
+      case 4: f(std::integral_constant<int, 4>{}); return;
+      case 5: f(std::integral_constant<int, 5>{}); return;
+      case 6: f(std::integral_constant<int, 6>{}); return;
+      case 7: f(std::integral_constant<int, 7>{}); return;
+      case 8: f(std::integral_constant<int, 8>{}); return;
+    }
+  }
+
+  // y = alpha * A * x + beta * y, with A (m x K). y is not read if beta == 0
+  template <int K, typename T> void gemv_k(int m, T alpha, T const *a, long a0, long a1, T const *x, long sx, T beta, T *y, long sy) {
+    for (int i = 0; i < m; ++i) {
+      T s = 0;
+      for (int k = 0; k < K; ++k) s += a[i * a0 + k * a1] * x[k * sx];
+      T &r = y[i * sy];
+      r    = (beta == T(0) ? alpha * s : alpha * s + beta * r);
+    }
+  }
+
+  template <typename MT, typename VT, typename VTOut>
+  void gemv(typename MT::value_type alpha, MT const &A, VT const &X, typename MT::value_type beta, VTOut &Y) {
+    using T        = typename VTOut::value_type;
+    auto const &sa = A.indexmap().strides();
+    auto f         = [&](auto K) {
+      gemv_k<decltype(K)::value, T>(first_dim(A), alpha, A.data_start(), sa[0], sa[1], X.data_start(), X.stride(), beta, Y.data_start(), Y.stride());
+    };
+    switch (second_dim(A)) {
+      case 0: f(std::integral_constant<int, 0>{}); return;
+      case 1: f(std::integral_constant<int, 1>{}); return;
+      case 2: f(std::integral_constant<int, 2>{}); return;
+      case 3: f(std::integral_constant<int, 3>{}); return;
+      case 4: f(std::integral_constant<int, 4>{}); return;
+      case 5: f(std::integral_constant<int, 5>{}); return;
+      case 6: f(std::integral_constant<int, 6>{}); return;
+      case 7: f(std::integral_constant<int, 7>{}); return;
+      case 8: f(std::integral_constant<int, 8>{}); return;
+    }
+  }
+
+  // Determinant of the n x n matrix (n <= 4) starting at p with strides (s0, s1)
+  template <typename T> T determinant(T const *p, int n, long s0, long s1) {
+    auto A = [p, s0, s1](int i, int j) { return p[i * s0 + j * s1]; };
+    switch (n) {
+      case 0: return 1;
+      case 1: return A(0, 0);
+      case 2: return A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+      case 3:
+        return A(0, 0) * (A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1)) + A(0, 1) * (A(1, 2) * A(2, 0) - A(1, 0) * A(2, 2))
+           + A(0, 2) * (A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0));
+      case 4: {
+        T s0_ = A(0, 0) * A(1, 1) - A(1, 0) * A(0, 1), s1_ = A(0, 0) * A(1, 2) - A(1, 0) * A(0, 2), s2_ = A(0, 0) * A(1, 3) - A(1, 0) * A(0, 3);
+        T s3_ = A(0, 1) * A(1, 2) - A(1, 1) * A(0, 2), s4_ = A(0, 1) * A(1, 3) - A(1, 1) * A(0, 3), s5_ = A(0, 2) * A(1, 3) - A(1, 2) * A(0, 3);
+        T c5 = A(2, 2) * A(3, 3) - A(3, 2) * A(2, 3), c4 = A(2, 1) * A(3, 3) - A(3, 1) * A(2, 3), c3 = A(2, 1) * A(3, 2) - A(3, 1) * A(2, 2);
+        T c2 = A(2, 0) * A(3, 3) - A(3, 0) * A(2, 3), c1 = A(2, 0) * A(3, 2) - A(3, 0) * A(2, 2), c0 = A(2, 0) * A(3, 1) - A(3, 0) * A(2, 1);
+        return s0_ * c5 - s1_ * c4 + s2_ * c3 + s3_ * c2 - s4_ * c1 + s5_ * c0;
+      }
+    }
+    TRIQS_RUNTIME_ERROR << "small_matrix::determinant : dimension " << n << " > 4";
+  }
+
+  // Invert in place the n x n matrix (n <= 4) starting at p with strides (s0, s1).
+  // Returns false (and leaves the matrix untouched) if it is singular.
+  template <typename T> bool inverse_in_place(T *p, int n, long s0, long s1) {
+    auto A = [p, s0, s1](int i, int j) -> T & { return p[i * s0 + j * s1]; };
+    switch (n) {
+      case 0: return true;
+      case 1: {
+        if (A(0, 0) == T(0)) return false;
+        A(0, 0) = T(1) / A(0, 0);
+        return true;
+      }
+      case 2: {
+        T a = A(0, 0), b = A(0, 1), c = A(1, 0), d = A(1, 1);
+        T det = a * d - b * c;
+        if (det == T(0)) return false;
+        T x     = T(1) / det;
+        A(0, 0) = d * x, A(0, 1) = -b * x, A(1, 0) = -c * x, A(1, 1) = a * x;
+        return true;
+      }
+      case 3: {
+        T a00 = A(0, 0), a01 = A(0, 1), a02 = A(0, 2);
+        T a10 = A(1, 0), a11 = A(1, 1), a12 = A(1, 2);
+        T a20 = A(2, 0), a21 = A(2, 1), a22 = A(2, 2);
+        T c00 = a11 * a22 - a12 * a21, c01 = a12 * a20 - a10 * a22, c02 = a10 * a21 - a11 * a20;
+        T det = a00 * c00 + a01 * c01 + a02 * c02;
+        if (det == T(0)) return false;
+        T x     = T(1) / det;
+        A(0, 0) = c00 * x, A(0, 1) = (a02 * a21 - a01 * a22) * x, A(0, 2) = (a01 * a12 - a02 * a11) * x;
+        A(1, 0) = c01 * x, A(1, 1) = (a00 * a22 - a02 * a20) * x, A(1, 2) = (a02 * a10 - a00 * a12) * x;
+        A(2, 0) = c02 * x, A(2, 1) = (a01 * a20 - a00 * a21) * x, A(2, 2) = (a00 * a11 - a01 * a10) * x;
+        return true;
+      }
+      case 4: {
+        // Cofactors from the 2x2 minors of the first two and last two rows
+        T m[16];
+        for (int i = 0; i < 4; ++i)
+          for (int j = 0; j < 4; ++j) m[4 * i + j] = A(i, j);
+        T s0_ = m[0] * m[5] - m[4] * m[1], s1_ = m[0] * m[6] - m[4] * m[2], s2_ = m[0] * m[7] - m[4] * m[3];
+        T s3_ = m[1] * m[6] - m[5] * m[2], s4_ = m[1] * m[7] - m[5] * m[3], s5_ = m[2] * m[7] - m[6] * m[3];
+        T c5 = m[10] * m[15] - m[14] * m[11], c4 = m[9] * m[15] - m[13] * m[11], c3 = m[9] * m[14] - m[13] * m[10];
+        T c2 = m[8] * m[15] - m[12] * m[11], c1 = m[8] * m[14] - m[12] * m[10], c0 = m[8] * m[13] - m[12] * m[9];
+        T det = s0_ * c5 - s1_ * c4 + s2_ * c3 + s3_ * c2 - s4_ * c1 + s5_ * c0;
+        if (det == T(0)) return false;
+        T x     = T(1) / det;
+        A(0, 0) = (m[5] * c5 - m[6] * c4 + m[7] * c3) * x;
+        A(0, 1) = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * x;
+        A(0, 2) = (m[13] * s5_ - m[14] * s4_ + m[15] * s3_) * x;
+        A(0, 3) = (-m[9] * s5_ + m[10] * s4_ - m[11] * s3_) * x;
+        A(1, 0) = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * x;
+        A(1, 1) = (m[0] * c5 - m[2] * c2 + m[3] * c1) * x;
+        A(1, 2) = (-m[12] * s5_ + m[14] * s2_ - m[15] * s1_) * x;
+        A(1, 3) = (m[8] * s5_ - m[10] * s2_ + m[11] * s1_) * x;
+        A(2, 0) = (m[4] * c4 - m[5] * c2 + m[7] * c0) * x;
+        A(2, 1) = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * x;
+        A(2, 2) = (m[12] * s4_ - m[13] * s2_ + m[15] * s0_) * x;
+        A(2, 3) = (-m[8] * s4_ + m[9] * s2_ - m[11] * s0_) * x;
+        A(3, 0) = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * x;
+        A(3, 1) = (m[0] * c3 - m[1] * c1 + m[2] * c0) * x;
+        A(3, 2) = (-m[12] * s3_ + m[13] * s1_ - m[14] * s0_) * x;
+        A(3, 3) = (m[8] * s3_ - m[9] * s1_ + m[10] * s0_) * x;
+        return true;
+      }
+    }
+    TRIQS_RUNTIME_ERROR << "small_matrix::inverse_in_place : dimension " << n << " > 4";
+  }
+
+} // namespace triqs::arrays::small_matrix
@@ -21,3 +21,4 @@
 #pragma once
 #include "./h5/simple_read_write.hpp"
 #include "./h5/array_of_non_basic.hpp"
+#include "./h5/mapped_array.hpp"
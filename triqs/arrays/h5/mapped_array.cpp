@@ -0,0 +1,106 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "./mapped_array.hpp"
+#include "./../../h5/base.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using dcomplex = std::complex<double>;
+namespace triqs {
+  namespace arrays {
+    namespace h5_impl {
+
+      h5::dataspace data_space_impl(array_stride_info info, bool is_complex); // in simple_read_write.cpp
+
+      long mappable_offset(h5::group g, std::string const &name, hid_t mem_type, size_t n_bytes) {
+        h5::dataset ds = g.open_dataset(name);
+
+        h5::proplist cparms = H5Dget_create_plist(ds);
+        if (H5Pget_layout(cparms) != H5D_CONTIGUOUS) return -1;
+        if (H5Pget_external_count(cparms) != 0) return -1;
+
+        h5::datatype ty = H5Dget_type(ds);
+        if (H5Tequal(ty, mem_type) <= 0) return -1;
+        if (H5Dget_storage_size(ds) != n_bytes) return -1;
+
+        // the offset is in the file only for the default driver (one file, no user block shift to handle)
+        h5::file f          = H5Iget_file_id(ds);
+        h5::proplist aparms = H5Fget_access_plist(f);
+        if (H5Pget_driver(aparms) != H5FD_SEC2) return -1;
+
+        haddr_t offset = H5Dget_offset(ds);
+        if (offset == HADDR_UNDEF) return -1; // not allocated
+
+        // the data may still be in the cache of hdf5
+        unsigned intent = 0;
+        H5Fget_intent(f, &intent);
+        if (intent != H5F_ACC_RDONLY) H5Fflush(f, H5F_SCOPE_LOCAL);
+        return long(offset);
+      }
+
+      void const *map_file(h5::group g, long offset, size_t n_bytes, void *&base, size_t &length) {
+        base   = nullptr;
+        length = 0;
+        h5::file f{H5Iget_file_id(g)};
+        int fd = ::open(f.name().c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+        long page    = ::sysconf(_SC_PAGESIZE);
+        long start   = offset - offset % page; // mmap needs an offset aligned on a page
+        size_t len   = n_bytes + (offset - start);
+        void *p      = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, start);
+        ::close(fd); // the mapping stays valid
+        if (p == MAP_FAILED) return nullptr;
+        base   = p;
+        length = len;
+        return static_cast<char const *>(p) + (offset - start);
+      }
+
+      void unmap_file(void *base, size_t length) { ::munmap(base, length); }
+
+      template <typename T> void read_array_slab_impl(h5::group g, std::string const &name, T *start, array_stride_info info, long first) {
+        bool is_complex       = triqs::is_complex<T>::value;
+        h5::dataset ds        = g.open_dataset(name);
+        h5::dataspace d_space = H5Dget_space(ds);
+
+        // the selection of the slab in the file
+        int rank = H5Sget_simple_extent_ndims(d_space);
+        hsize_t dims[rank], L[rank], S[rank], offset[rank];
+        H5Sget_simple_extent_dims(d_space, dims, NULL);
+        for (int u = 0; u < info.R; ++u) {
+          L[u]      = info.lengths[u];
+          S[u]      = 1;
+          offset[u] = (u == 0 ? first : 0);
+        }
+        h5::dataspace f_space = h5::dataspace_from_LS(info.R, is_complex, dims, L, S, offset);
+
+        herr_t err = H5Dread(ds, h5::data_type_memory<T>(), data_space_impl(info, is_complex), f_space, H5P_DEFAULT, h5::get_data_ptr(start));
+        if (err < 0) TRIQS_RUNTIME_ERROR << "Error reading a slab of the dataset " << name << " in the group" << g.name();
+      }
+
+      template void read_array_slab_impl<int>(h5::group g, std::string const &name, int *start, array_stride_info info, long first);
+      template void read_array_slab_impl<long>(h5::group g, std::string const &name, long *start, array_stride_info info, long first);
+      template void read_array_slab_impl<double>(h5::group g, std::string const &name, double *start, array_stride_info info, long first);
+      template void read_array_slab_impl<dcomplex>(h5::group g, std::string const &name, dcomplex *start, array_stride_info info, long first);
+
+    } // namespace h5_impl
+  }   // namespace arrays
+} // namespace triqs
@@ -0,0 +1,162 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./simple_read_write.hpp"
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace triqs {
+  namespace arrays {
+    namespace h5_impl {
+
+      // The data of the dataset can be mapped from the file if it is contiguous, allocated, of the native type mem_type,
+      // of n_bytes bytes, in a single file. Returns the offset of the data in the file, or -1 if it can not be mapped.
+      long mappable_offset(h5::group g, std::string const &name, hid_t mem_type, size_t n_bytes);
+
+      // Map n_bytes of the file of g, from offset, read-only. Returns the address of the data (nullptr if it fails),
+      // base and length are what is to be given to unmap_file.
+      void const *map_file(h5::group g, long offset, size_t n_bytes, void *&base, size_t &length);
+      void unmap_file(void *base, size_t length);
+
+      // Read the slab [first, first + info.lengths[0]) of the first dimension of the dataset. Contiguous data only.
+      template <typename T> void read_array_slab_impl(h5::group g, std::string const &name, T *start, array_stride_info info, long first);
+
+    } // namespace h5_impl
+
+    /**
+     * A read-only array from a dataset of an h5 file, without copy when it is possible.
+     *
+     * If the dataset is contiguous and uncompressed (cf h5_write_contiguous) and of the same type as T, its data are mapped
+     * from the file (mmap) : the construction is O(1), the pages are read on demand, and shared by all the processes reading the file.
+     * Otherwise (compressed datasets written by h5_write, other type in the file...), the data are read with hdf5 :
+     * the whole array the first time operator() is called, or part of it with read_slab.
+     *
+     * The file must not be modified while the mapped_array is alive.
+     * The lazy loading in operator() is not thread safe.
+     */
+    template <typename T, int R> class mapped_array {
+      static_assert(is_scalar<T>::value, "mapped_array : the value_type must be a scalar");
+      static constexpr bool is_complex = triqs::is_complex<T>::value;
+      using scalar_t                   = std::conditional_t<is_complex, double, T>;
+
+      h5::group _g;
+      std::string _name;
+      bool _file_is_complex = false;
+      mini_vector<size_t, R> _lengths;
+      void *_map_base    = nullptr;
+      size_t _map_length = 0;
+      T const *_mapped   = nullptr;
+      mutable std::optional<array<T, R>> _data; // the data read with hdf5, if not mapped
+
+      public:
+      using view_type = array_const_view<T, R>;
+
+      mapped_array() = default;
+
+      /// Open the dataset name of g, and map it if possible
+      mapped_array(h5::group g, std::string const &name) : _g(g), _name(name) {
+        _file_is_complex = h5_impl::is_dataset_complex(g, name);
+        if (is_complex and !_file_is_complex) {
+          _lengths = mini_vector<size_t, R>(h5_impl::get_array_lengths(R, g, name, false));
+          return;
+        }
+        if (!is_complex and _file_is_complex) TRIQS_RUNTIME_ERROR << "mapped_array : can not read the complex dataset " << name << " into a real array";
+        _lengths     = mini_vector<size_t, R>(h5_impl::get_array_lengths(R, g, name, is_complex));
+        size_t bytes = _lengths.product_of_elements() * sizeof(T);
+        if (bytes == 0) return;
+        long offset = h5_impl::mappable_offset(g, name, h5::data_type_memory<scalar_t>(), bytes);
+        if (offset < 0) return;
+        auto p = h5_impl::map_file(g, offset, bytes, _map_base, _map_length);
+        if (p and reinterpret_cast<std::uintptr_t>(p) % alignof(T) == 0)
+          _mapped = static_cast<T const *>(p);
+        else
+          _unmap();
+      }
+
+      mapped_array(mapped_array const &) = delete;
+      mapped_array(mapped_array &&x) noexcept { swap(*this, x); }
+      mapped_array &operator=(mapped_array const &) = delete;
+      mapped_array &operator=(mapped_array &&x) noexcept {
+        swap(*this, x);
+        return *this;
+      }
+
+      ~mapped_array() { _unmap(); }
+
+      friend void swap(mapped_array &a, mapped_array &b) noexcept {
+        using std::swap;
+        swap(a._g, b._g);
+        swap(a._name, b._name);
+        swap(a._file_is_complex, b._file_is_complex);
+        swap(a._lengths, b._lengths);
+        swap(a._map_base, b._map_base);
+        swap(a._map_length, b._map_length);
+        swap(a._mapped, b._mapped);
+        swap(a._data, b._data);
+      }
+
+      /// Are the data mapped from the file ?
+      bool is_mapped() const { return _mapped != nullptr; }
+
+      /// Shape of the array
+      mini_vector<size_t, R> const &shape() const { return _lengths; }
+
+      /// A view of the data. If they are not mapped, they are read on the first call.
+      view_type operator()() const {
+        if (_mapped) return view_type{typename view_type::indexmap_type{_lengths}, nda::mem::handle<T, 'B'>{const_cast<T *>(_mapped), _size()}};
+        if (!_data) {
+          _data.emplace();
+          h5_read(_g, _name, *_data);
+        }
+        return *_data;
+      }
+
+      /// A copy of the elements [first, last) of the first dimension. If the data are not mapped, only this part of the dataset is read.
+      array<T, R> read_slab(long first, long last) const {
+        if (first < 0 or last < first or last > long(_lengths[0]))
+          TRIQS_RUNTIME_ERROR << "mapped_array : the slab [" << first << ", " << last << ") is out of [0, " << _lengths[0] << ")";
+        if (_mapped or _data) return operator()()(range(first, last), ellipsis());
+        auto L = _lengths;
+        L[0]   = last - first;
+        if (is_complex and !_file_is_complex) {
+          array<double, R> tmp(L);
+          if (tmp.size() > 0) h5_impl::read_array_slab_impl(_g, _name, tmp.data_start(), h5_impl::array_stride_info{tmp}, first);
+          return tmp;
+        }
+        array<T, R> res(L);
+        if (res.size() > 0) h5_impl::read_array_slab_impl(_g, _name, res.data_start(), h5_impl::array_stride_info{res}, first);
+        return res;
+      }
+
+      private:
+      size_t _size() const { return _lengths.product_of_elements(); }
+
+      void _unmap() {
+        if (_map_base) h5_impl::unmap_file(_map_base, _map_length);
+        _map_base   = nullptr;
+        _map_length = 0;
+        _mapped     = nullptr;
+      }
+    };
+
+  } // namespace arrays
+} // namespace triqs
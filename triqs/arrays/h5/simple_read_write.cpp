@@ -45,18 +45,21 @@ namespace triqs {
 
       /// --------------------------- WRITE ---------------------------------------------
 
-      template <typename T> void write_array_impl(h5::group g, std::string const &name, const T *start, array_stride_info info) {
+      template <typename T> void write_array_impl(h5::group g, std::string const &name, const T *start, array_stride_info info, bool compress) {
         static_assert(!std::is_base_of<std::string, T>::value, " Not implemented"); // 1d is below
         bool is_complex       = triqs::is_complex<T>::value;
         h5::dataspace d_space = data_space_impl(info, is_complex);
 
         h5::proplist cparms = H5Pcreate(H5P_DATASET_CREATE);
-        int n_dims          = info.R + (is_complex ? 1 : 0);
-        hsize_t chunk_dims[n_dims];
-        for (int i : range(info.R)) chunk_dims[i] = std::max(info.lengths[i], 1ul);
-        if (is_complex) chunk_dims[n_dims - 1] = 2;
-        H5Pset_chunk(cparms, n_dims, chunk_dims);
-        H5Pset_deflate(cparms, 1);
+        if (compress) {
+          int n_dims = info.R + (is_complex ? 1 : 0);
+          hsize_t chunk_dims[n_dims];
+          for (int i : range(info.R)) chunk_dims[i] = std::max(info.lengths[i], 1ul);
+          if (is_complex) chunk_dims[n_dims - 1] = 2;
+          H5Pset_chunk(cparms, n_dims, chunk_dims);
+          H5Pset_deflate(cparms, 1);
+        } else // contiguous, allocated at creation
+          H5Pset_alloc_time(cparms, H5D_ALLOC_TIME_EARLY);
 
         h5::dataset ds = g.create_dataset(name, h5::data_type_file<T>(), d_space, cparms);
 
@@ -69,10 +72,10 @@ namespace triqs {
         if (is_complex) h5_write_attribute(ds, "__complex__", "1");
       }
 
-      template void write_array_impl<int>(h5::group g, std::string const &name, const int *start, array_stride_info info);
-      template void write_array_impl<long>(h5::group g, std::string const &name, const long *start, array_stride_info info);
-      template void write_array_impl<double>(h5::group g, std::string const &name, const double *start, array_stride_info info);
-      template void write_array_impl<dcomplex>(h5::group g, std::string const &name, const dcomplex *start, array_stride_info info);
+      template void write_array_impl<int>(h5::group g, std::string const &name, const int *start, array_stride_info info, bool compress);
+      template void write_array_impl<long>(h5::group g, std::string const &name, const long *start, array_stride_info info, bool compress);
+      template void write_array_impl<double>(h5::group g, std::string const &name, const double *start, array_stride_info info, bool compress);
+      template void write_array_impl<dcomplex>(h5::group g, std::string const &name, const dcomplex *start, array_stride_info info, bool compress);
 
       // overload : special treatment for arrays of strings (one dimension only).
       void write_array(h5::group g, std::string const &name, vector_const_view<std::string> V) {
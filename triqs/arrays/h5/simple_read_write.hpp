@@ -53,15 +53,16 @@ namespace triqs {
 
       /*********************************** WRITE array ****************************************************************/
 
-      template <typename T> void write_array_impl(h5::group g, std::string const &name, const T *start, array_stride_info info);
+      // compress : chunked and compressed dataset. Otherwise, contiguous and uncompressed.
+      template <typename T> void write_array_impl(h5::group g, std::string const &name, const T *start, array_stride_info info, bool compress = true);
 
-      template <typename A> void write_array(h5::group g, std::string const &name, A const &a, bool C_reorder = true) {
+      template <typename A> void write_array(h5::group g, std::string const &name, A const &a, bool C_reorder = true, bool compress = true) {
         if (C_reorder) {
           auto c = make_const_cache(a);
           auto b = c.view();
-          write_array_impl(g, name, b.data_start(), array_stride_info{b});
+          write_array_impl(g, name, b.data_start(), array_stride_info{b}, compress);
         } else
-          write_array_impl(g, name, a.data_start(), array_stride_info{a});
+          write_array_impl(g, name, a.data_start(), array_stride_info{a}, compress);
       }
 
       // overload : special treatment for arrays of strings (one dimension only).
@@ -140,5 +141,15 @@ namespace triqs {
       h5_impl::write_array(g, name, array_const_view<typename ArrayType::value_type, ArrayType::rank>(A));
     }
 
+    /*
+  * Write an array or a view into an hdf5 file, as a contiguous and uncompressed dataset
+  * Larger in the file than with h5_write, but it can be read without any copy with mapped_array.
+  */
+    template <typename ArrayType>
+    ENABLE_IFC(is_amv_value_or_view_class<ArrayType>::value &&is_scalar<typename ArrayType::value_type>::value)
+    h5_write_contiguous(h5::group g, std::string const &name, ArrayType const &A) {
+      h5_impl::write_array(g, name, array_const_view<typename ArrayType::value_type, ArrayType::rank>(A), true, false);
+    }
+
   } // namespace arrays
 } // namespace triqs
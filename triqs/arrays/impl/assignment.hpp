@@ -23,6 +23,7 @@
 #include "iterator_adapter.hpp"
 #include "../indexmaps/cuboid/foreach.hpp"
 #include "../storages/memcopy.hpp"
+#include "./flat_assignment.hpp"
 
 namespace triqs {
   namespace arrays {
@@ -132,12 +133,8 @@ namespace triqs {
           if (!indexmaps::compatible_for_assignment(lhs.indexmap(), rhs.indexmap()))
             TRIQS_RUNTIME_ERROR << "Size mismatch in operation " << OP << " : LHS " << lhs << " \n RHS = " << rhs;
 #endif
-          if ((false && (OP == 'E') && indexmaps::raw_copy_possible(lhs.indexmap(), rhs.indexmap()))) {
-	    nda::mem::memcopy(lhs.data_start(), rhs.data_start(), rhs.indexmap().domain().number_of_elements());
-          } else {
-            foreach (lhs, *this)
+          if (!flat::try_apply<_ops_<v_t, typename RHS::value_type, OP>>(lhs, rhs)) foreach (lhs, *this)
               ;
-          }
         }
       };
 
@@ -156,8 +153,8 @@ namespace triqs {
           _ops_<value_type, typename RHS::value_type, OP>::invoke(lhs(args...), rhs(args...));
         }
         FORCEINLINE void invoke() {
-          foreach (lhs, *this)
-            ;
+          if (!flat::try_apply<_ops_<value_type, typename RHS::value_type, OP>>(lhs, rhs)) foreach (lhs, *this)
+              ;
         }
       };
 
@@ -171,7 +168,9 @@ namespace triqs {
         LHS &lhs;
         const RHS &rhs;
         impl(LHS &lhs_, const RHS &rhs_) : lhs(lhs_), rhs(rhs_) {}
-        FORCEINLINE void invoke() { assign_foreach(lhs, rhs); }
+        FORCEINLINE void invoke() {
+          if (!flat::try_apply<_ops_<value_type, typename RHS::value_type, 'E'>>(lhs, rhs)) assign_foreach(lhs, rhs);
+        }
       };
 
       // -----------------   assignment for scalar RHS, except some matrix case --------------------------------------------------
@@ -185,8 +184,11 @@ namespace triqs {
         impl(LHS &lhs_, const RHS &rhs_) : lhs(lhs_), rhs(rhs_) {}
         template <typename... Args> void operator()(Args const &... args) const { _ops_<value_type, RHS, OP>::invoke(lhs(args...), rhs); }
         void invoke() {
-          foreach (lhs, *this)
-            ;
+          if (lhs.indexmap().is_contiguous())
+            flat::apply<_ops_<value_type, RHS, OP>>(lhs, [this](long) -> RHS const & { return rhs; }, true);
+          else
+            foreach (lhs, *this)
+              ;
         }
       };
 
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <type_traits>
+#include <triqs/utility/expression_template_tools.hpp>
+
+namespace triqs {
+  namespace arrays {
+
+    namespace Tag {
+      struct indexmap_storage_pair;
+    }
+    template <typename Tag, typename L, typename R> struct array_expr;
+    template <typename L> struct array_unary_m_expr;
+    template <typename S, bool IsMatrix> struct _scalar_wrap;
+
+    // Fast path of the assignment, when the LHS is contiguous and all the arrays of the RHS have the same
+    // lengths and strides as the LHS : the element at position i in memory of the LHS is computed from
+    // the elements at the same position in the RHS arrays, so a single loop over the linear index suffices.
+    // The traversal is in memory order, like foreach on the LHS, so aliasing behaves as in the general case.
+    namespace assignment::flat {
+
+      /// Above this number of elements, the flat assignment of scalars is distributed over the OpenMP threads,
+      /// in the code compiled with OpenMP (the triqs target propagates the flags).
+      inline long parallel_threshold = 1 << 16;
+
+      // Can E be evaluated at a linear position ?
+      template <typename E, typename Enable = void> struct is_evaluable : std::false_type {};
+      template <typename E> struct is_evaluable<E, std::enable_if_t<std::is_base_of<Tag::indexmap_storage_pair, E>::value>> : std::true_type {};
+      template <typename S> struct is_evaluable<_scalar_wrap<S, false>> : std::true_type {};
+      template <typename Tag, typename L, typename R>
+      struct is_evaluable<array_expr<Tag, L, R>> : std::integral_constant<bool, is_evaluable<std::decay_t<L>>::value and is_evaluable<std::decay_t<R>>::value> {};
+      template <typename L> struct is_evaluable<array_unary_m_expr<L>> : is_evaluable<std::decay_t<L>> {};
+
+      template <typename Map, typename Tag, typename L, typename R>
+      bool same_layout(Map const &m, char const *b, long size, array_expr<Tag, L, R> const &e, bool &no_overlap);
+      template <typename Map, typename L> bool same_layout(Map const &m, char const *b, long size, array_unary_m_expr<L> const &e, bool &no_overlap);
+      template <typename Tag, typename L, typename R> auto eval_at(array_expr<Tag, L, R> const &e, long i);
+      template <typename L> auto eval_at(array_unary_m_expr<L> const &e, long i);
+
+      // Check at runtime that all arrays in e are laid out as the LHS (map m, memory [b, b + size)).
+      // no_overlap is set to false if one of them shares part of its memory with the LHS, without coinciding with it.
+      template <typename Map, typename E> bool same_layout(Map const &m, char const *b, long size, E const &e, bool &no_overlap) {
+        if constexpr (std::is_base_of<Tag::indexmap_storage_pair, E>::value) {
+          if ((e.indexmap().lengths() != m.lengths()) or (e.indexmap().strides() != m.strides())) return false;
+          auto b2  = reinterpret_cast<char const *>(e.data_start());
+          long s2 = m.size() * sizeof(*e.data_start());
+          if ((b2 != b) and (b2 < b + size) and (b < b2 + s2)) no_overlap = false;
+        }
+        return true;
+      }
+      template <typename Map, typename Tag, typename L, typename R>
+      bool same_layout(Map const &m, char const *b, long size, array_expr<Tag, L, R> const &e, bool &no_overlap) {
+        return same_layout(m, b, size, e.l, no_overlap) and same_layout(m, b, size, e.r, no_overlap);
+      }
+      template <typename Map, typename L> bool same_layout(Map const &m, char const *b, long size, array_unary_m_expr<L> const &e, bool &no_overlap) {
+        return same_layout(m, b, size, e.l, no_overlap);
+      }
+
+      // Value of e at the linear position i
+      template <typename E> FORCEINLINE decltype(auto) eval_at(E const &e, long i) {
+        if constexpr (std::is_base_of<Tag::indexmap_storage_pair, E>::value)
+          return e.data_start()[i];
+        else
+          return e.s;
+      }
+      template <typename Tag, typename L, typename R> FORCEINLINE auto eval_at(array_expr<Tag, L, R> const &e, long i) {
+        return utility::operation<Tag>()(eval_at(e.l, i), eval_at(e.r, i));
+      }
+      template <typename L> FORCEINLINE auto eval_at(array_unary_m_expr<L> const &e, long i) { return -eval_at(e.l, i); }
+
+      // lhs[i] OP= f(i) for all i, in memory order of the lhs
+      template <typename Ops, typename LHS, typename F> void apply(LHS &lhs, F const &f, bool no_overlap) {
+        auto *p = lhs.data_start();
+        long n  = lhs.indexmap().size();
+        if constexpr (is_scalar<std::remove_cv_t<typename LHS::value_type>>::value) {
+          if (no_overlap) {
+#pragma omp parallel for simd if (parallel : n >= parallel_threshold) schedule(static)
+            for (long i = 0; i < n; ++i) Ops::invoke(p[i], f(i));
+            return;
+          }
+        }
+        for (long i = 0; i < n; ++i) Ops::invoke(p[i], f(i));
+      }
+
+      // lhs OP= rhs through the flat path, if the layouts allow it. Returns false otherwise, without touching lhs.
+      template <typename Ops, typename LHS, typename RHS> bool try_apply(LHS &lhs, RHS const &rhs) {
+        if constexpr (is_evaluable<RHS>::value) {
+          bool no_overlap = true;
+          auto b          = reinterpret_cast<char const *>(lhs.data_start());
+          if (!lhs.indexmap().is_contiguous() or !same_layout(lhs.indexmap(), b, lhs.indexmap().size() * sizeof(*lhs.data_start()), rhs, no_overlap))
+            return false;
+          apply<Ops>(lhs, [&rhs](long i) -> decltype(auto) { return eval_at(rhs, i); }, no_overlap);
+          return true;
+        } else
+          return false;
+      }
+
+    } // namespace assignment::flat
+  }   // namespace arrays
+} // namespace triqs
@@ -0,0 +1,143 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./det_and_inverse.hpp"
+#include <exception>
+#include <vector>
+#include <numeric>
+
+namespace triqs::arrays {
+
+  namespace detail {
+
+    // Invert in place the n x n matrix starting at p, with strides (s0, s1).
+    // The workspace (pivots and getri work array) is kept between calls.
+    template <typename T> class batched_inverse_worker {
+      vector<int> ipiv;
+      std::vector<T> work, scratch;
+      long work_n = -1; // dimension for which the size of work was optimized
+
+      static void singular() { throw matrix_inverse_exception() << "Inverse/Det error : matrix is not invertible"; }
+
+      public:
+      void operator()(T *p, long n, long s0, long s1) {
+        if (n <= 4) {
+          if (!small_matrix::inverse_in_place(p, n, s0, s1)) singular();
+        } else
+          lapack_inverse(p, n, s0, s1);
+      }
+
+      private:
+      // getrf + getri, directly on the data if one of the strides is 1, on a scratch copy otherwise.
+      // The inverse of the transpose being the transpose of the inverse, a C ordered matrix
+      // can be passed as a Fortran ordered one.
+      void lapack_inverse(T *p, long n, long s0, long s1) {
+        T *q   = p;
+        int ld = 0;
+        if (s1 == 1 and s0 >= n)
+          ld = s0;
+        else if (s0 == 1 and s1 >= n)
+          ld = s1;
+        else {
+          scratch.resize(n * n);
+          for (long i = 0; i < n; ++i)
+            for (long j = 0; j < n; ++j) scratch[i + n * j] = p[i * s0 + j * s1];
+          q  = scratch.data();
+          ld = n;
+        }
+
+        if (ipiv.size() < n) ipiv.resize(n);
+        int info;
+        lapack::f77::getrf(n, n, q, ld, ipiv.data_start(), info);
+        if (info != 0) singular();
+
+        if (work_n != n) { // first call to get the optimal lwork
+          T work1[2];
+          lapack::f77::getri(n, q, ld, ipiv.data_start(), work1, -1, info);
+          work.resize(std::max<size_t>(lapack::r_round(work1[0]), n));
+          work_n = n;
+        }
+        lapack::f77::getri(n, q, ld, ipiv.data_start(), work.data(), work.size(), info);
+        if (info != 0) singular();
+
+        if (q == scratch.data())
+          for (long i = 0; i < n; ++i)
+            for (long j = 0; j < n; ++j) p[i * s0 + j * s1] = scratch[i + n * j];
+      }
+    };
+  } // namespace detail
+
+  /**
+   * Invert in place all the square matrices stored in the last two indices of an array,
+   * i.e. a(x..., range(), range()) for all x...
+   *
+   * Matrices up to 4x4 are inverted with closed-form expressions, larger ones with LAPACK
+   * using a workspace shared by all the matrices treated by a thread. The matrices are distributed
+   * over OpenMP threads, in the code compiled with OpenMP.
+   *
+   * @param a The array, of rank >= 2
+   * @param block_sizes If not empty, the matrices are block diagonal, with consecutive diagonal blocks of these sizes.
+   *        Each block is inverted separately; the elements outside of the blocks are not accessed.
+   */
+  template <typename T, int R> void inverse_in_place_batched(array_view<T, R> a, std::vector<long> const &block_sizes = {}) {
+    static_assert(R >= 2, "inverse_in_place_batched : the array must be of rank >= 2");
+    auto const &l = a.indexmap().lengths();
+    auto const &s = a.indexmap().strides();
+    long n        = l[R - 1];
+    if (l[R - 2] != n) TRIQS_RUNTIME_ERROR << "Inverse : matrices are not square but of size " << l[R - 2] << " x " << n;
+
+    std::vector<long> blocks = block_sizes.empty() ? std::vector<long>{n} : block_sizes;
+    if (std::accumulate(blocks.begin(), blocks.end(), 0l) != n) TRIQS_RUNTIME_ERROR << "Inverse : block sizes do not add up to the matrix size " << n;
+
+    long n_mat = 1;
+    for (int r = 0; r < R - 2; ++r) n_mat *= l[r];
+    long s0 = s[R - 2], s1 = s[R - 1];
+
+    T *start = a.data_start();
+    std::exception_ptr error;
+
+#pragma omp parallel
+    {
+      detail::batched_inverse_worker<T> worker;
+#pragma omp for schedule(static)
+      for (long k = 0; k < n_mat; ++k) {
+        try {
+          // Position of the k-th matrix (C ordering of the batch indices)
+          long shift = 0;
+          for (long r = R - 3, kk = k; r >= 0; --r) {
+            shift += (kk % l[r]) * s[r];
+            kk /= l[r];
+          }
+          long offset = 0;
+          for (long b : blocks) {
+            worker(start + shift + offset * (s0 + s1), b, s0, s1);
+            offset += b;
+          }
+        } catch (...) {
+#pragma omp critical(inverse_in_place_batched_error)
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+} // namespace triqs::arrays
@@ -24,6 +24,7 @@
 #include "../matrix.hpp"
 #include "../blas_lapack/getrf.hpp"
 #include "../blas_lapack/getri.hpp"
+#include "../blas_lapack/small_matrix.hpp"
 
 namespace triqs {
   namespace arrays {
@@ -159,7 +160,16 @@ namespace triqs {
 
       void activate() const {
         if (computed) return;
-        M           = a;
+        M = a;
+        if constexpr (is_blas_lapack_type<value_type>::value) {
+          if (first_dim(M) <= 4) { // closed form, no LAPACK call
+            auto const &s = M.indexmap().strides();
+            if (!small_matrix::inverse_in_place(M.data_start(), first_dim(M), s[0], s[1]))
+              throw matrix_inverse_exception() << "Inverse/Det error : matrix is not invertible";
+            computed = true;
+            return;
+          }
+        }
         auto worker = det_and_inverse_worker<M_view_type>{M};
         worker.inverse();
         computed = true;
@@ -187,6 +197,13 @@ namespace triqs {
     //------------------- det   ----------------------------------------
 
     template <typename A> typename std::remove_reference<A>::type::value_type determinant(A &&a) {
+      using A_t = std::decay_t<A>;
+      if constexpr (is_amv_value_or_view_class<A_t>::value and is_blas_lapack_type<typename A_t::value_type>::value) {
+        if (first_dim(a) <= 4 and first_dim(a) == second_dim(a)) { // closed form, no copy
+          auto const &s = a.indexmap().strides();
+          return small_matrix::determinant(a.data_start(), first_dim(a), s[0], s[1]);
+        }
+      }
       // makes a temporary copy of A if A is a const &
       // If a is a matrix &&, it is moved into the worker.
       auto worker = det_and_inverse_worker<matrix<typename std::remove_reference<A>::type::value_type>>(std::forward<A>(a));
@@ -24,6 +24,7 @@
 #include "../matrix.hpp"
 #include "../vector.hpp"
 #include <triqs/utility/exceptions.hpp>
+#include <exception>
 
 namespace triqs {
   namespace arrays {
@@ -50,46 +51,187 @@ namespace triqs {
                                          double[],               // WORK2
                                          int &                   // INFO
       );
+
+      void TRIQS_FORTRAN_MANGLING(dsyevd)(char *, char *, int &, double[], int &, double[], // JOBZ, UPLO, N, A, LDA, W
+                                          double[], int &, int[], int &, int &                // WORK, LWORK, IWORK, LIWORK, INFO
+      );
+
+      void TRIQS_FORTRAN_MANGLING(zheevd)(char *, char *, int &, std::complex<double>[], int &, double[], // JOBZ, UPLO, N, A, LDA, W
+                                          std::complex<double>[], int &, double[], int &,                 // WORK, LWORK, RWORK, LRWORK
+                                          int[], int &, int &                                             // IWORK, LIWORK, INFO
+      );
+
+      void TRIQS_FORTRAN_MANGLING(dsyevr)(char *, char *, char *, int &, double[], int &, // JOBZ, RANGE, UPLO, N, A, LDA
+                                          double &, double &, int &, int &, double &,     // VL, VU, IL, IU, ABSTOL
+                                          int &, double[], double[], int &, int[],        // M, W, Z, LDZ, ISUPPZ
+                                          double[], int &, int[], int &, int &            // WORK, LWORK, IWORK, LIWORK, INFO
+      );
+
+      void TRIQS_FORTRAN_MANGLING(zheevr)(char *, char *, char *, int &, std::complex<double>[], int &,   // JOBZ, RANGE, UPLO, N, A, LDA
+                                          double &, double &, int &, int &, double &,                     // VL, VU, IL, IU, ABSTOL
+                                          int &, double[], std::complex<double>[], int &, int[],          // M, W, Z, LDZ, ISUPPZ
+                                          std::complex<double>[], int &, double[], int &, int[], int &, int & // WORK, LWORK, RWORK, LRWORK, IWORK, LIWORK, INFO
+      );
       }
 
+      /// LAPACK driver used for the diagonalization
+      enum class eigensolver {
+        syev,  ///< QR iteration (dsyev/zheev)
+        syevd, ///< Divide and conquer (dsyevd/zheevd) : faster for the full set of eigenvectors, needs more memory
+        syevr  ///< MRRR (dsyevr/zheevr) : fastest for a part of the spectrum
+      };
+
+      /// Part of the spectrum to compute
+      struct spectrum_range {
+        char kind    = 'A'; // 'A' all, 'I' by index, 'V' by value, as the RANGE argument of LAPACK
+        double v_min = 0, v_max = 0;
+        int i_min = 0, i_max = 0;
+
+        /// The whole spectrum
+        static spectrum_range all() { return {}; }
+
+        /// The eigenvalues i_min, ..., i_max - 1 in ascending order
+        static spectrum_range by_index(int i_min, int i_max) { return {'I', 0, 0, i_min, i_max}; }
+
+        /// The eigenvalues in the interval (v_min, v_max]
+        static spectrum_range by_value(double v_min, double v_max) { return {'V', v_min, v_max, 0, 0}; }
+      };
+
       /**
    * A worker to call lapack routine with the matrices. Handles both real and complex case.
+   * The LAPACK workspaces are kept, and reused when the worker is called again on matrices of the same size.
    */
       template <typename T> class eigenelements_worker {
         public:
-        eigenelements_worker() = default;
+        /**
+     * @param solver The LAPACK driver
+     * @param range Part of the spectrum. With syev and syevd, the full spectrum is computed then restricted.
+     */
+        eigenelements_worker(eigensolver solver = eigensolver::syev, spectrum_range range = {}) : solver(solver), range(range) {}
 
         /// The eigenvalues
         template <typename M> array<double, 1> eigenvalues(M &mat) const {
           _prepare(mat);
-          _invoke(is_complex<T>(), 'N', mat);
-          return ev;
+          int m = _invoke('N', mat);
+          return ev(range_t(first, first + m));
         }
 
-        /// The eigensystems
+        /// The eigensystems. The eigenvectors are the rows of the matrix.
         template <typename M> std::pair<array<double, 1>, matrix<T>> eigenelements(M &mat) const {
           _prepare(mat);
-          _invoke(is_complex<T>(), 'V', mat);
-          return {ev, _conj(mat, is_complex<T>())};
+          int m = _invoke('V', mat);
+          if (solver == eigensolver::syevr) { // the eigenvectors are the m first columns of z, in Fortran order, i.e. its first rows in C order
+            matrix_view<T> zm = z(range_t(0, m), range_t());
+            return {ev(range_t(0, m)), _conj_if_c_order(mat, zm)};
+          }
+          matrix<T> vec = _conj(mat, is_complex<T>());
+          if (m == dim) return {ev, std::move(vec)};
+          return {ev(range_t(first, first + m)), vec(range_t(first, first + m), range_t())};
         }
 
         private:
+        using range_t = arrays::range;
+        eigensolver solver;
+        spectrum_range range;
         mutable array<double, 1> ev, work2; // work2 only used for T complex
         mutable array<T, 1> work;
-        mutable int dim, lwork, info;
+        mutable array<int, 1> iwork, isuppz;
+        mutable matrix<T> z;
+        mutable int dim = 0, lwork = 0, lwork2 = 0, liwork = 0, info = 0, first = 0;
+        mutable int ws_dim = -1;  // dimension for which the workspace was computed
+        mutable char ws_jobz = 0; // and job
 
-        // dispatch the implementation of invoke for T = double or complex
-        void _invoke(std::false_type, char compz, matrix_view<double> mat) const { // the case double (is_complex = false)
-          char uplo = 'U';
-          TRIQS_FORTRAN_MANGLING(dsyev)(&compz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lwork, info);
-          if (info) TRIQS_RUNTIME_ERROR << "eigenelements_worker :error code dsyev : " << info << " for matrix " << mat;
+        // The driver. Returns the number of eigenvalues found. With syevr, they are the first ones of ev,
+        // otherwise, the spectrum is complete and they start at first.
+        int _invoke(char jobz, matrix_view<T> mat) const {
+          if (ws_dim != dim or ws_jobz != jobz) _query_workspace(jobz, mat);
+          if (solver == eigensolver::syevr) return _call_evr(jobz, mat, false);
+          _call(jobz, mat, false);
+          if (info) TRIQS_RUNTIME_ERROR << "eigenelements_worker : error code " << info << " in LAPACK for matrix " << mat;
+          return _restrict_range();
         }
 
-        void _invoke(std::true_type, char compz, matrix_view<std::complex<double>> mat) const { // the case complex (is_complex = true)
+        void _query_workspace(char jobz, matrix_view<T> mat) const {
+          ws_dim  = dim;
+          ws_jobz = jobz;
+          if (solver == eigensolver::syev) {
+            lwork = 64 * dim;
+            work.resize(lwork);
+            if (is_complex<T>::value) work2.resize(std::max(1, 3 * dim - 2));
+            return;
+          }
+          if (solver == eigensolver::syevr) {
+            isuppz.resize(2 * dim);
+            if (jobz == 'V') z.resize(dim, dim);
+          }
+          // LAPACK workspace query
+          work.resize(1);
+          work2.resize(1);
+          iwork.resize(1);
+          if (solver == eigensolver::syevr)
+            _call_evr(jobz, mat, true);
+          else
+            _call(jobz, mat, true);
+          if (info) TRIQS_RUNTIME_ERROR << "eigenelements_worker : error code " << info << " in LAPACK workspace query";
+          lwork  = int(std::real(work(0)));
+          lwork2 = (is_complex<T>::value ? int(work2(0)) : 0);
+          liwork = iwork(0);
+          work.resize(std::max(1, lwork));
+          work2.resize(std::max(1, lwork2));
+          iwork.resize(std::max(1, liwork));
+        }
+
+        // syev or syevd
+        void _call(char jobz, matrix_view<T> mat, bool query) const {
           char uplo = 'U';
-          TRIQS_FORTRAN_MANGLING(zheev)
-          (&compz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lwork, work2.data_start(), info);
-          if (info) TRIQS_RUNTIME_ERROR << "eigenelements_worker :error code zheev : " << info << " for matrix " << mat;
+          int lw = (query ? -1 : lwork), lw2 = (query ? -1 : lwork2), liw = (query ? -1 : liwork);
+          if constexpr (is_complex<T>::value) {
+            if (solver == eigensolver::syev)
+              TRIQS_FORTRAN_MANGLING(zheev)
+              (&jobz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lwork, work2.data_start(), info);
+            else
+              TRIQS_FORTRAN_MANGLING(zheevd)
+              (&jobz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lw, work2.data_start(), lw2, iwork.data_start(), liw, info);
+          } else {
+            if (solver == eigensolver::syev)
+              TRIQS_FORTRAN_MANGLING(dsyev)(&jobz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lwork, info);
+            else
+              TRIQS_FORTRAN_MANGLING(dsyevd)(&jobz, &uplo, dim, mat.data_start(), dim, ev.data_start(), work.data_start(), lw, iwork.data_start(), liw, info);
+          }
+        }
+
+        // syevr
+        int _call_evr(char jobz, matrix_view<T> mat, bool query) const {
+          char uplo = 'U', rg = range.kind;
+          int lw = (query ? -1 : lwork), lw2 = (query ? -1 : lwork2), liw = (query ? -1 : liwork);
+          int il = range.i_min + 1, iu = range.i_max, m = 0, ldz = dim;
+          double vl = range.v_min, vu = range.v_max, abstol = 0;
+          T *zp = (jobz == 'V' ? z.data_start() : nullptr);
+          T dummy;
+          if (zp == nullptr) zp = &dummy;
+          if constexpr (is_complex<T>::value)
+            TRIQS_FORTRAN_MANGLING(zheevr)
+          (&jobz, &rg, &uplo, dim, mat.data_start(), dim, vl, vu, il, iu, abstol, m, ev.data_start(), zp, ldz, isuppz.data_start(), work.data_start(), lw,
+           work2.data_start(), lw2, iwork.data_start(), liw, info);
+          else TRIQS_FORTRAN_MANGLING(dsyevr)(&jobz, &rg, &uplo, dim, mat.data_start(), dim, vl, vu, il, iu, abstol, m, ev.data_start(), zp, ldz,
+                                              isuppz.data_start(), work.data_start(), lw, iwork.data_start(), liw, info);
+          if (!query and info) TRIQS_RUNTIME_ERROR << "eigenelements_worker : error code " << info << " in LAPACK syevr for matrix " << mat;
+          return m;
+        }
+
+        // Select the range in the full (ascending) spectrum ev
+        int _restrict_range() const {
+          first = 0;
+          switch (range.kind) {
+            case 'I': first = range.i_min; return range.i_max - range.i_min;
+            case 'V': {
+              while (first < dim and ev(first) <= range.v_min) ++first;
+              int last = first;
+              while (last < dim and ev(last) <= range.v_max) ++last;
+              return last - first;
+            }
+          }
+          return dim;
         }
 
         template <typename M> void _prepare(M const &mat) const {
@@ -97,13 +239,21 @@ namespace triqs {
           if (!mat.is_square()) TRIQS_RUNTIME_ERROR << "eigenelements_worker : the matrix " << mat << " is not square ";
           if (!mat.indexmap().is_contiguous()) TRIQS_RUNTIME_ERROR << "eigenelements_worker : the matrix " << mat << " is not contiguous in memory";
           dim = first_dim(mat);
-          ev.resize(dim);
-          lwork = 64 * dim;
-          work.resize(lwork);
-          if (is_complex<T>::value) work2.resize(lwork);
+          if (range.kind == 'I' and (range.i_min < 0 or range.i_max > dim or range.i_min >= range.i_max))
+            TRIQS_RUNTIME_ERROR << "eigenelements_worker : index range [" << range.i_min << ", " << range.i_max << ") invalid for a matrix of size " << dim;
+          if (range.kind == 'V' and !(range.v_min < range.v_max))
+            TRIQS_RUNTIME_ERROR << "eigenelements_worker : empty value range (" << range.v_min << ", " << range.v_max << "]";
+          first = 0;
+          if (ev.size() != dim) ev.resize(dim);
         }
 
-        template <typename M> matrix<double> _conj(M const &m, std::false_type) const { return m; }
+        // a fortran ordered matrix contains the eigenvectors in its columns, cf below
+        template <typename M> matrix<double> _conj(M const &m, std::false_type) const {
+          if (m.memory_layout_is_c())
+            return m;
+          else
+            return m.transpose();
+        }
 
         // impl : since we call fortran lapack, if the order is C (!), the matrix is transposed, or conjugated, so we obtain
         // the conjugate of the eigenvectors... Fix #119.
@@ -116,6 +266,14 @@ namespace triqs {
                                   // correct answer.
                                   // but since it is a fortran matrix, the C will see its transpose. We need to compensate this transpose (!).
         }
+
+        // For syevr, z is ours : only the conjugation of a C ordered complex input matters
+        template <typename M> matrix<T> _conj_if_c_order(M const &mat, matrix_view<T> zm) const {
+          if constexpr (is_complex<T>::value) {
+            if (mat.memory_layout_is_c()) return conj(zm);
+          }
+          return zm;
+        }
       };
 
       //--------------------------------
@@ -124,10 +282,14 @@ namespace triqs {
    * Simple diagonalization call, return all eigenelements.
    * Handles both real and complex case.
    * @param M : the matrix or view.
+   * @param solver : the LAPACK driver
+   * @param range : the part of the spectrum to compute
    */
-      template <typename M> std::pair<array<double, 1>, matrix<typename M::value_type>> eigenelements(M const &m) {
+      template <typename M>
+      std::pair<array<double, 1>, matrix<typename M::value_type>> eigenelements(M const &m, eigensolver solver = eigensolver::syev,
+                                                                                spectrum_range range = {}) {
         auto m2 = make_clone(m);
-        return eigenelements_worker<typename M::value_type>().eigenelements(m2);
+        return eigenelements_worker<typename M::value_type>(solver, range).eigenelements(m2);
       }
 
       //--------------------------------
@@ -138,8 +300,10 @@ namespace triqs {
    * Works in place, i.e. changes the matrix
    * @param M : the matrix or view.
    */
-      template <typename M> std::pair<array<double, 1>, matrix<typename M::value_type>> eigenelements_in_place(M *m) {
-        return eigenelements_worker<typename M::value_type>().eigenelements(*m);
+      template <typename M>
+      std::pair<array<double, 1>, matrix<typename M::value_type>> eigenelements_in_place(M *m, eigensolver solver = eigensolver::syev,
+                                                                                         spectrum_range range = {}) {
+        return eigenelements_worker<typename M::value_type>(solver, range).eigenelements(*m);
       }
 
       //--------------------------------
@@ -149,9 +313,9 @@ namespace triqs {
    * Handles both real and complex case.
    * @param M : the matrix VIEW : it MUST be contiguous
    */
-      template <typename M> array<double, 1> eigenvalues(M const &m) {
+      template <typename M> array<double, 1> eigenvalues(M const &m, eigensolver solver = eigensolver::syev, spectrum_range range = {}) {
         auto m2 = make_clone(m);
-        return eigenelements_worker<typename M::value_type>().eigenvalues(m2);
+        return eigenelements_worker<typename M::value_type>(solver, range).eigenvalues(m2);
       }
 
       //--------------------------------
@@ -161,7 +325,72 @@ namespace triqs {
    * Handles both real and complex case.
    * @param M : the matrix VIEW : it MUST be contiguous
    */
-      template <typename M> array<double, 1> eigenvalues_in_place(M *m) { return eigenelements_worker<typename M::value_type>().eigenvalues(*m); }
+      template <typename M> array<double, 1> eigenvalues_in_place(M *m, eigensolver solver = eigensolver::syev, spectrum_range range = {}) {
+        return eigenelements_worker<typename M::value_type>(solver, range).eigenvalues(*m);
+      }
+
+      //--------------------------------
+
+      namespace detail {
+        // Diagonalize the matrices a(b, :, :) with one worker per thread, and call f(b, worker, matrix)
+        template <typename T, typename F> void eigen_batched(array_const_view<T, 3> a, eigensolver solver, spectrum_range range, F f) {
+          if (range.kind == 'V') TRIQS_RUNTIME_ERROR << "eigenelements_batched : the number of eigenvalues must be the same for all matrices (no value range)";
+          long n_b = a.shape(0);
+          std::exception_ptr error;
+#pragma omp parallel
+          {
+            eigenelements_worker<T> worker(solver, range);
+            matrix<T> mat;
+#pragma omp for schedule(static)
+            for (long b = 0; b < n_b; ++b) {
+              try {
+                mat = a(b, arrays::range(), arrays::range());
+                f(b, worker, mat);
+              } catch (...) {
+#pragma omp critical(eigen_batched_error)
+                error = std::current_exception();
+              }
+            }
+          }
+          if (error) std::rethrow_exception(error);
+        }
+
+        inline long n_eigen(long n, spectrum_range const &range) { return (range.kind == 'I' ? range.i_max - range.i_min : n); }
+      } // namespace detail
+
+      /**
+   * Diagonalize a batch of matrices of the same size, e.g. H(k) for all k.
+   * The matrices are distributed over the OpenMP threads (in the code compiled with OpenMP), each thread reusing its LAPACK workspace.
+   * @param a : the matrices a(b, :, :)
+   * @param solver : the LAPACK driver
+   * @param range : the part of the spectrum to compute. A value range is not allowed.
+   * @return (ev, vec), with ev(b, i) the i-th eigenvalue of the b-th matrix and vec(b, i, :) the corresponding eigenvector
+   */
+      template <typename A, typename T = std::remove_const_t<typename A::value_type>>
+      std::pair<array<double, 2>, array<T, 3>> eigenelements_batched(A const &a, eigensolver solver = eigensolver::syevd, spectrum_range range = {}) {
+        static_assert(get_rank<A>::value == 3, "eigenelements_batched : the matrices are a(b, :, :)");
+        long n = a.shape(1), m = detail::n_eigen(n, range);
+        array<double, 2> ev(a.shape(0), m);
+        array<T, 3> vec(a.shape(0), m, n);
+        detail::eigen_batched<T>(a, solver, range, [&](long b, auto &worker, auto &mat) {
+          auto r = worker.eigenelements(mat);
+          ev(b, arrays::range())                   = r.first;
+          vec(b, arrays::range(), arrays::range()) = r.second;
+        });
+        return {std::move(ev), std::move(vec)};
+      }
+
+      /**
+   * Eigenvalues of a batch of matrices of the same size, cf eigenelements_batched
+   * @return ev(b, i) the i-th eigenvalue of the b-th matrix
+   */
+      template <typename A, typename T = std::remove_const_t<typename A::value_type>>
+      array<double, 2> eigenvalues_batched(A const &a, eigensolver solver = eigensolver::syevd, spectrum_range range = {}) {
+        static_assert(get_rank<A>::value == 3, "eigenvalues_batched : the matrices are a(b, :, :)");
+        array<double, 2> ev(a.shape(0), detail::n_eigen(a.shape(1), range));
+        detail::eigen_batched<T>(a, solver, range, [&](long b, auto &worker, auto &mat) { ev(b, arrays::range()) = worker.eigenvalues(mat); });
+        return ev;
+      }
     } // namespace linalg
   }   // namespace arrays
 } // namespace triqs
@@ -20,6 +20,8 @@
  ******************************************************************************/
 #pragma once
 #include <mpi/mpi.hpp>
+#include <mpi/vector.hpp>
+#include <mpi/nonblocking.hpp>
 
 namespace triqs {
   namespace arrays {
@@ -91,6 +93,14 @@ namespace triqs {
       return {a, c, root, all, nullptr};
     }
 
+    /// The numbers of a contiguous array of double or dcomplex, for the packed reduction of containers (cf mpi/vector.hpp)
+    template <typename A, typename F>
+    std::enable_if_t<is_amv_value_or_view_class<std::decay_t<A>>::value and mpi::is_packable_scalar<typename std::decay_t<A>::value_type>>
+    mpi_foreach_payload(A &&a, F const &f) {
+      if (!has_contiguous_data(a)) TRIQS_RUNTIME_ERROR << "Non contiguous view in mpi_reduce";
+      f(a.data_start(), long(a.domain().number_of_elements()));
+    }
+
 #undef REQUIRES_IS_ARRAY
 #undef REQUIRES_IS_ARRAY2
 
@@ -0,0 +1,143 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./array.hpp"
+#include <mpi/mpi.hpp>
+#include <utility>
+
+namespace triqs {
+  namespace arrays {
+
+    /**
+     * A read-only array stored once per compute node, in an MPI-3 shared memory window.
+     *
+     * All the nodes of the communicator running on the same machine see the same memory, through
+     * the array_const_view returned by operator().
+     * The shared_array must outlive the views, and is destroyed collectively (on all the nodes of the communicator).
+     */
+    template <typename T, int R> class shared_array {
+      static_assert(mpi::has_mpi_type<T>, "shared_array : the value_type must be an mpi type");
+
+      MPI_Win _win = MPI_WIN_NULL;
+      mpi::communicator _node{MPI_COMM_NULL};
+      array_const_view<T, R> _view;
+
+      public:
+      using view_type = array_const_view<T, R>;
+
+      shared_array() = default;
+
+      /**
+       * Allocate the window on the first node of each machine (collective on the nodes of c sharing memory).
+       *
+       * @param lengths The lengths of the array
+       * @param node The communicator of the nodes sharing the memory (cf communicator::split_shared)
+       * @param fill If not null, called on the first node of each machine with a view of the (uninitialized) array,
+       *        before the other nodes are allowed to read it.
+       */
+      template <typename F = std::nullptr_t> shared_array(mini_vector<size_t, R> const &lengths, mpi::communicator node, F fill = nullptr) : _node(node) {
+        long n           = lengths.product_of_elements();
+        bool is_owner    = (_node.rank() == 0);
+        MPI_Aint n_bytes = (is_owner ? n * sizeof(T) : 0);
+        T *p             = nullptr;
+        MPI_Win_allocate_shared(n_bytes, sizeof(T), MPI_INFO_NULL, _node.get(), &p, &_win);
+        if (!is_owner) {
+          MPI_Aint size;
+          int disp_unit;
+          MPI_Win_shared_query(_win, 0, &size, &disp_unit, &p);
+        }
+        _view.rebind(view_type{typename view_type::indexmap_type{lengths}, nda::mem::handle<T, 'B'>{p, size_t(n)}});
+
+        MPI_Win_fence(0, _win);
+        if constexpr (!std::is_same_v<F, std::nullptr_t>) {
+          if (is_owner) fill(array_view<T, R>{_view.indexmap(), _view.storage()});
+        }
+        MPI_Win_fence(0, _win);
+      }
+
+      shared_array(shared_array const &) = delete;
+      shared_array(shared_array &&x) noexcept { swap(*this, x); }
+      shared_array &operator=(shared_array const &) = delete;
+      shared_array &operator=(shared_array &&x) noexcept {
+        swap(*this, x);
+        return *this;
+      }
+
+      ~shared_array() {
+        if (_win != MPI_WIN_NULL) MPI_Win_free(&_win);
+        if (_node.get() != MPI_COMM_NULL) {
+          MPI_Comm c = _node.get();
+          MPI_Comm_free(&c);
+        }
+      }
+
+      friend void swap(shared_array &a, shared_array &b) noexcept {
+        std::swap(a._win, b._win);
+        std::swap(a._node, b._node);
+        std::swap(a._view, b._view);
+      }
+
+      /// A view of the shared data
+      view_type operator()() const { return _view; }
+
+      /// The communicator of the nodes sharing the data
+      mpi::communicator const &node_communicator() const { return _node; }
+
+      auto shape() const { return _view.shape(); }
+    };
+
+    /**
+     * Broadcast the array a from root into memory shared by the nodes on the same machine.
+     *
+     * The data are sent once to each machine, copied into a shared memory window on its first node,
+     * and all the other nodes of the machine get a view of it, without any copy.
+     * The argument is only read on root.
+     *
+     * @return The shared_array, whose operator() gives the (C ordered) view of the data.
+     */
+    template <typename A>
+    std::enable_if_t<is_amv_value_or_view_class<A>::value, shared_array<typename A::value_type, A::rank>>
+    mpi_broadcast_shared(A const &a, mpi::communicator c = {}, int root = 0) {
+      using T = typename A::value_type;
+      constexpr int R = A::rank;
+
+      auto lengths = a.shape();
+      MPI_Bcast(&lengths[0], R, mpi::mpi_type<size_t>::get(), root, c.get());
+
+      // root is the first node of its machine, and the first of the communicator between machines.
+      bool is_root = (c.rank() == root);
+      auto node    = c.split_shared(is_root ? 0 : 1);
+      bool leader  = (node.rank() == 0);
+      MPI_Comm inter;
+      MPI_Comm_split(c.get(), (leader ? 0 : MPI_UNDEFINED), (is_root ? 0 : 1), &inter);
+
+      return shared_array<T, R>{lengths, node, [&](array_view<T, R> v) {
+                                  if (is_root) v = a;
+                                  constexpr long max_count = 1l << 30;
+                                  long n                   = v.size();
+                                  for (long start = 0; start < n; start += max_count)
+                                    MPI_Bcast(v.data_start() + start, int(std::min(max_count, n - start)), mpi::mpi_type<T>::get(), 0, inter);
+                                  MPI_Comm_free(&inter);
+                                }};
+    }
+
+  } // namespace arrays
+} // namespace triqs
@@ -305,7 +305,7 @@ namespace triqs {
           h_matrix(range(), i)   = f_state.amplitudes();
         }
 
-        auto eig                   = linalg::eigenelements(h_matrix);
+        auto eig                   = linalg::eigenelements(h_matrix, linalg::eigensolver::syevd);
         eigensystem.eigenvalues    = eig.first;
         eigensystem.unitary_matrix = eig.second.transpose(); // Convert from eigenvectors as rows to columns.
         hdiag->gs_energy           = std::min(hdiag->gs_energy, eigensystem.eigenvalues[0]);
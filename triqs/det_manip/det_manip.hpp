@@ -39,6 +39,35 @@ namespace triqs {
 
     namespace blas = arrays::blas;
 
+    /*
+     * The function may optionally fill a whole row, column or matrix at once, e.g. to vectorize its evaluation :
+     *
+     *   f.row(x, Y, out)    : out(k)    = f(x, Y[k])
+     *   f.col(X, y, out)    : out(k)    = f(X[k], y)
+     *   f.matrix(X, Y, out) : out(i, j) = f(X[i], Y[j])
+     *
+     * where X, Y are std::vector of the arguments, and out a vector_view (resp. matrix_view) of the same size.
+     * Each of them is optional : det_manip falls back to calling f(x, y) element by element.
+     */
+    template <typename F, typename X, typename Y, typename V, typename = void> struct has_batched_row : std::false_type {};
+    template <typename F, typename X, typename Y, typename V>
+    struct has_batched_row<F, X, Y, V,
+                           std::void_t<decltype(std::declval<F const &>().row(std::declval<X const &>(), std::declval<std::vector<Y> const &>(),
+                                                                              std::declval<arrays::vector_view<V>>()))>> : std::true_type {};
+
+    template <typename F, typename X, typename Y, typename V, typename = void> struct has_batched_col : std::false_type {};
+    template <typename F, typename X, typename Y, typename V>
+    struct has_batched_col<F, X, Y, V,
+                           std::void_t<decltype(std::declval<F const &>().col(std::declval<std::vector<X> const &>(), std::declval<Y const &>(),
+                                                                              std::declval<arrays::vector_view<V>>()))>> : std::true_type {};
+
+    template <typename F, typename X, typename Y, typename V, typename = void> struct has_batched_matrix : std::false_type {};
+    template <typename F, typename X, typename Y, typename V>
+    struct has_batched_matrix<F, X, Y, V,
+                              std::void_t<decltype(std::declval<F const &>().matrix(std::declval<std::vector<X> const &>(),
+                                                                                    std::declval<std::vector<Y> const &>(),
+                                                                                    std::declval<arrays::matrix_view<V>>()))>> : std::true_type {};
+
     /**
   * @brief Standard matrix/det manipulations used in several QMC.
   */
@@ -58,6 +87,7 @@ namespace triqs {
                     "det_manip : the function must return a floating number or a complex number");
 
       using vector_type            = arrays::vector<value_type>;
+      using vector_view_type       = arrays::vector_view<value_type>;
       using matrix_type            = arrays::matrix<value_type>;
       using matrix_view_type       = arrays::matrix_view<value_type>;
       using matrix_const_view_type = arrays::matrix_const_view<value_type>;
@@ -92,6 +122,20 @@ namespace triqs {
       double singular_threshold = -1; // the test to see if the matrix is singular is abs(det) > singular_threshold. If <0, it is !isnormal(abs(det))
       double precision_warning = 1.e-8; // bound for warning message in check for singular matrix
       double precision_error = 1.e-5; // bound for throwing error in check for singular matrix
+      uint64_t n_probes_per_check = 0; // if >0, number of rows and columns of M M^-1 - 1 probed by the check, instead of a full regeneration
+
+      public:
+      /// Statistics of the checks of the deviation of M^-1, for diagnostics
+      struct check_stats_t {
+        uint64_t n_checks        = 0; // number of checks done
+        uint64_t n_regenerations = 0; // number of full regenerations done by the checks
+        double last_deviation    = 0; // deviation found by the last check
+        double max_deviation     = 0; // max of the deviations found by the checks
+      };
+
+      private:
+      check_stats_t check_stats;
+      size_t next_probe = 0; // first row/column probed by the next check
 
       private:
       //  ------------     BOOST Serialization ------------
@@ -210,6 +254,9 @@ namespace triqs {
         SW(mat_inv);
         SW(n_opts);
         SW(n_opts_max_before_check);
+        SW(n_probes_per_check);
+        SW(check_stats);
+        SW(next_probe);
         SW(w1);
         SW(w2);
         SW(newdet);
@@ -269,7 +316,26 @@ namespace triqs {
 
       /// Set the bound for throwing error in the singular tests
       void set_precision_error(double threshold) { precision_error = threshold; }
-      
+
+      /// Gets the number of rows and columns probed by the check of M^-1 (0 : full regeneration at each check).
+      uint64_t get_n_probes_per_check() const { return n_probes_per_check; }
+
+      /**
+     * Sets the number of rows and columns probed by the check of M^-1, done every n_operations_before_check operations.
+     *
+     * If n > 0, the check computes n rows of M M^-1 - 1 and n columns of M^-1 M - 1, in O(n N^2) instead of O(N^3),
+     * and regenerates the matrix only when their largest element is above the precision_warning.
+     * The rows and columns probed change from one check to the next, so that all of them are probed in turn.
+     * If n = 0 (default), the check is a full regeneration, compared element-wise to M^-1.
+     */
+      void set_n_probes_per_check(uint64_t n) { n_probes_per_check = n; }
+
+      /// Statistics of the checks of M^-1 since the construction (or the last reset_check_stats)
+      check_stats_t const &get_check_stats() const { return check_stats; }
+
+      /// Reset the statistics of the checks
+      void reset_check_stats() { check_stats = {}; }
+
       /**
      * @brief Constructor.
      *
@@ -306,9 +372,9 @@ namespace triqs {
         for (size_t i = 0; i < N; ++i) {
           row_num.push_back(i);
           col_num.push_back(i);
-          for (size_t j = 0; j < N; ++j) mat_inv(i, j) = f(x_values[i], y_values[j]);
         }
         range R(0, N);
+        _fill_matrix(x_values, y_values, mat_inv(R, R));
         det           = arrays::determinant(mat_inv(R, R));
         mat_inv(R, R) = inverse(mat_inv(R, R));
       }
@@ -427,6 +493,35 @@ namespace triqs {
           ;
       }
 
+      // ------------------------- Evaluation of the function -----------------------------------
+
+      private:
+      // out(k) = f(x, Y[k])
+      void _fill_row(x_type const &x, std::vector<y_type> const &Y, vector_view_type out) const {
+        if constexpr (has_batched_row<FunctionType, x_type, y_type, value_type>::value)
+          f.row(x, Y, out);
+        else
+          for (size_t k = 0; k < Y.size(); ++k) out(k) = f(x, Y[k]);
+      }
+
+      // out(k) = f(X[k], y)
+      void _fill_col(std::vector<x_type> const &X, y_type const &y, vector_view_type out) const {
+        if constexpr (has_batched_col<FunctionType, x_type, y_type, value_type>::value)
+          f.col(X, y, out);
+        else
+          for (size_t k = 0; k < X.size(); ++k) out(k) = f(X[k], y);
+      }
+
+      // out(i, j) = f(X[i], Y[j])
+      void _fill_matrix(std::vector<x_type> const &X, std::vector<y_type> const &Y, matrix_view_type out) const {
+        if constexpr (has_batched_matrix<FunctionType, x_type, y_type, value_type>::value)
+          f.matrix(X, Y, out);
+        else
+          for (size_t i = 0; i < X.size(); ++i)
+            for (size_t j = 0; j < Y.size(); ++j) out(i, j) = f(X[i], Y[j]);
+      }
+
+      public:
       // ------------------------- OPERATIONS -----------------------------------------------
 
       /**
@@ -475,11 +570,9 @@ namespace triqs {
 
         // I add the row and col and the end. If the move is rejected,
         // no effect since N will not be changed : Minv(i,j) for i,j>=N has no meaning.
-        for (size_t k = 0; k < N; k++) {
-          w1.B(k) = f(x_values[k], y);
-          w1.C(k) = f(x, y_values[k]);
-        }
         range R(0, N);
+        _fill_col(x_values, y, w1.B(R));
+        _fill_row(x, y_values, w1.C(R));
         //w1.MB(R) = mat_inv(R,R) * w1.B(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.B(R), 0.0, w1.MB(R));
         w1.ksi  = f(x, y) - arrays::dot(w1.C(R), w1.MB(R));
@@ -635,13 +728,11 @@ namespace triqs {
 
         // I add the rows and cols and the end. If the move is rejected,
         // no effect since N will not be changed : inv_mat(i,j) for i,j>=N has no meaning.
-        for (size_t k = 0; k < N; k++) {
-          w2.B(k, 0) = f(x_values[k], y0);
-          w2.B(k, 1) = f(x_values[k], y1);
-          w2.C(0, k) = f(x0, y_values[k]);
-          w2.C(1, k) = f(x1, y_values[k]);
-        }
         range R(0, N), R2(0, 2);
+        _fill_col(x_values, y0, w2.B(R, 0));
+        _fill_col(x_values, y1, w2.B(R, 1));
+        _fill_row(x0, y_values, w2.C(0, R));
+        _fill_row(x1, y_values, w2.C(1, R));
         //w2.MB(R,R2) = mat_inv(R,R) * w2.B(R,R2); // OPTIMIZE BELOW
         blas::gemm(1.0, mat_inv(R, R), w2.B(R, R2), 0.0, w2.MB(R, R2));
         //w2.ksi -= w2.C (R2, R) * w2.MB(R, R2); // OPTIMIZE BELOW
@@ -905,8 +996,10 @@ namespace triqs {
         w1.y     = y;
 
         // Compute the col B.
-        for (size_t i = 0; i < N; i++) w1.MC(i) = f(x_values[i], w1.y) - f(x_values[i], y_values[w1.jreal]);
         range R(0, N);
+        _fill_col(x_values, w1.y, w1.MC(R));
+        _fill_col(x_values, y_values[w1.jreal], w1.B(R));
+        w1.MC(R) -= w1.B(R);
         //w1.MB(R) = mat_inv(R,R) * w1.MC(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.MC(R), 0.0, w1.MB(R));
 
@@ -953,8 +1046,10 @@ namespace triqs {
         w1.x     = x;
 
         // Compute the col B.
-        for (size_t i = 0; i < N; i++) w1.MB(i) = f(w1.x, y_values[i]) - f(x_values[w1.ireal], y_values[i]);
         range R(0, N);
+        _fill_row(w1.x, y_values, w1.MB(R));
+        _fill_row(x_values[w1.ireal], y_values, w1.C(R));
+        w1.MB(R) -= w1.C(R);
         //w1.MC(R) = mat_inv(R,R).transpose() * w1.MB(R); // OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R).transpose(), w1.MB(R), 0.0, w1.MC(R));
 
@@ -1005,14 +1100,17 @@ namespace triqs {
         w1.y     = y;
 
         // Compute the col B.
-        for (size_t i = 0; i < N; i++) { // MC :  delta_x, MB : delta_y
-          w1.MC(i) = f(x_values[i], y) - f(x_values[i], y_values[w1.jreal]);
-          w1.MB(i) = f(x, y_values[i]) - f(x_values[w1.ireal], y_values[i]);
-        }
+        range R(0, N);
+        // MC :  delta_x, MB : delta_y
+        _fill_col(x_values, y, w1.MC(R));
+        _fill_col(x_values, y_values[w1.jreal], w1.B(R));
+        w1.MC(R) -= w1.B(R);
+        _fill_row(x, y_values, w1.MB(R));
+        _fill_row(x_values[w1.ireal], y_values, w1.C(R));
+        w1.MB(R) -= w1.C(R);
         w1.MC(w1.ireal) = f(x, y) - f(x_values[w1.ireal], y_values[w1.jreal]);
         w1.MB(w1.jreal) = 0;
 
-        range R(0, N);
         // C : X, B : Y
         //w1.C(R) = mat_inv(R,R) * w1.MC(R);// OPTIMIZE BELOW
         blas::gemv(1.0, mat_inv(R, R), w1.MC(R), 0.0, w1.C(R));
@@ -1093,9 +1191,8 @@ namespace triqs {
         std::copy(X.begin(), X.end(), std::back_inserter(w_refill.x_values));
         std::copy(Y.begin(), Y.end(), std::back_inserter(w_refill.y_values));
 
-        for (size_t i = 0; i < s; ++i)
-          for (size_t j = 0; j < s; ++j) w_refill.M(i, j) = f(w_refill.x_values[i], w_refill.y_values[j]);
         range R(0, s);
+        _fill_matrix(w_refill.x_values, w_refill.y_values, w_refill.M(R, R));
         newdet  = arrays::determinant(w_refill.M(R, R));
         newsign = 1;
 
@@ -1139,8 +1236,7 @@ namespace triqs {
 
         range R(0, N);
         matrix_type res(N, N);
-        for (int i = 0; i < N; i++)
-          for (int j = 0; j < N; j++) res(i, j) = f(x_values[i], y_values[j]);
+        _fill_matrix(x_values, y_values, res());
         det = arrays::determinant(res);
         if (is_singular()) {
           res()    = std::numeric_limits<double>::quiet_NaN();
@@ -1184,7 +1280,41 @@ namespace triqs {
         sign = (s > 0 ? 1 : -1);
       }
 
+      // max of abs(M M^-1 - 1) on n_probes_per_check rows, and of abs(M^-1 M - 1) on as many columns. O(n_probes_per_check N^2)
+      double _probe_deviation() {
+        range R(0, N);
+        auto Minv = mat_inv(R, R);
+        vector_type m(N), v(N);
+        double r = 0;
+        for (size_t p = 0; p < std::min<size_t>(n_probes_per_check, N); ++p, ++next_probe) {
+          size_t k = next_probe % N;
+          // row k of M M^-1
+          _fill_row(x_values[k], y_values, m());
+          blas::gemv(1.0, Minv.transpose(), m, 0.0, v);
+          v(k) -= 1;
+          r = std::max(r, max_element(abs(v)));
+          // column k of M^-1 M
+          _fill_col(x_values, y_values[k], m());
+          blas::gemv(1.0, Minv, m, 0.0, v);
+          v(k) -= 1;
+          r = std::max(r, max_element(abs(v)));
+        }
+        next_probe %= N;
+        return r;
+      }
+
       void check_mat_inv() {
+        ++check_stats.n_checks;
+        if (n_probes_per_check > 0 and N > 0) {
+          double r                   = _probe_deviation();
+          check_stats.last_deviation = r;
+          check_stats.max_deviation  = std::max(check_stats.max_deviation, r);
+          if (!(r > precision_warning)) { // NaN regenerates
+            n_opts = 0;
+            return;
+          }
+        }
+        ++check_stats.n_regenerations;
         _regenerate_with_check(true, precision_warning, precision_error);
       }
 
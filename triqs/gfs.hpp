@@ -63,8 +63,10 @@
 // functions
 #include "./gfs/functions/closest_mesh_pt.hpp"
 #include "./gfs/functions/functions2.hpp"
+#include "./gfs/block/symmetric_block_gf.hpp"
 #include "./gfs/functions/imfreq.hpp"
 #include "./gfs/functions/imtime.hpp"
+#include "./gfs/functions/imtime_spline.hpp"
 #include "./gfs/functions/product.hpp"
 #include "./gfs/functions/legendre.hpp"
 #include "./gfs/functions/density.hpp"
@@ -579,9 +579,9 @@ namespace triqs {
         if (l.rhs.size() != this->size())
           TRIQS_RUNTIME_ERROR << "mpi reduction of block_gf : size of RHS is incompatible with the size of the view to be assigned to";
         _block_names = l.rhs.block_names();
-        for (int i = 0; i < size(); ++i) _glist[i] = mpi::reduce(l.rhs.data()[i], l.c, l.root, l.all, l.op);
-        // here we need to enumerate the vector, the mpi::reduce produce a vector<gf>, NOT a gf_view,
-        // we can not overload the = of vector for better API.
+        // all the blocks are reduced with a single collective : packed directly from the blocks of the rhs,
+        // and unpacked into the blocks of this view, without intermediate copy of the block_gf
+        mpi::detail::reduce_packed(l.rhs.data(), _glist, l.c, l.root, l.all, l.op);
       }
 
       /**
@@ -1541,10 +1541,9 @@ namespace triqs {
         if (l.rhs.size() != this->size())
           TRIQS_RUNTIME_ERROR << "mpi reduction of block_gf : size of RHS is incompatible with the size of the view to be assigned to";
         _block_names = l.rhs.block_names();
-        for (int i = 0; i < size1(); ++i)
-          for (int j = 0; j < size2(); ++j) _glist[i][j] = mpi::reduce(l.rhs.data()[i][j], l.c, l.root, l.all, l.op);
-        // here we need to enumerate the vector, the mpi::reduce produce a vector<gf>, NOT a gf_view,
-        // we can not overload the = of vector for better API.
+        // all the blocks are reduced with a single collective : packed directly from the blocks of the rhs,
+        // and unpacked into the blocks of this view, without intermediate copy of the block_gf
+        mpi::detail::reduce_packed(l.rhs.data(), _glist, l.c, l.root, l.all, l.op);
       }
 
       /**
@@ -2058,6 +2057,9 @@ namespace triqs {
       return {a(), c, root, all, op};
     }
 
+    /// The numbers of all the blocks, for the packed and non-blocking reductions (cf mpi/vector.hpp)
+    template <typename G, typename F> std::enable_if_t<is_block_gf_v<G>> mpi_foreach_payload(G &&g, F const &f) { mpi::mpi_foreach_payload(g.data(), f); }
+
     // -------------------------------   Free Factories for regular type  --------------------------------------------------
 
     ///
@@ -383,14 +383,9 @@ namespace triqs {
         if (l.rhs.size() != this->size())
           TRIQS_RUNTIME_ERROR << "mpi reduction of block_gf : size of RHS is incompatible with the size of the view to be assigned to";
         _block_names = l.rhs.block_names();
-        // mako %if ARITY == 1 :
-        for (int i = 0; i < size(); ++i) _glist[i] = mpi::reduce(l.rhs.data()[i], l.c, l.root, l.all, l.op);
-        // mako %else:
-        for (int i = 0; i < size1(); ++i)
-          for (int j = 0; j < size2(); ++j) _glist[i][j] = mpi::reduce(l.rhs.data()[i][j], l.c, l.root, l.all, l.op);
-        // mako %endif
-        // here we need to enumerate the vector, the mpi::reduce produce a vector<gf>, NOT a gf_view,
-        // we can not overload the = of vector for better API.
+        // all the blocks are reduced with a single collective : packed directly from the blocks of the rhs,
+        // and unpacked into the blocks of this view, without intermediate copy of the block_gf
+        mpi::detail::reduce_packed(l.rhs.data(), _glist, l.c, l.root, l.all, l.op);
       }
 
       /**
@@ -656,6 +651,9 @@ namespace triqs {
     // mako %endfor
     // mako %endfor
 
+    /// The numbers of all the blocks, for the packed and non-blocking reductions (cf mpi/vector.hpp)
+    template <typename G, typename F> std::enable_if_t<is_block_gf_v<G>> mpi_foreach_payload(G &&g, F const &f) { mpi::mpi_foreach_payload(g.data(), f); }
+
     // -------------------------------   Free Factories for regular type  --------------------------------------------------
 
     ///
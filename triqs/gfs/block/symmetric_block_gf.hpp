@@ -0,0 +1,375 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./block_gf.hxx"
+#include "../functions/functions2.hpp"
+#include <mpi/vector.hpp>
+
+namespace triqs {
+  namespace gfs {
+
+    /// How a block is obtained from its source
+    enum class block_op : long {
+      identity,            ///< A copy of the unique block
+      conjugate,           ///< Complex conjugate of the data of the unique block
+      transpose,           ///< Transpose of the target, at each mesh point (square matrix_valued only)
+      conjugate_transpose, ///< Both
+      zero                 ///< A zero block : no data stored, the source is the index of its (mesh, target shape)
+    };
+
+    /// The symmetry giving one block : block = op(source)
+    struct block_symmetry {
+      long source = 0;
+      block_op op = block_op::identity;
+      bool operator==(block_symmetry const &x) const { return source == x.source and op == x.op; }
+      bool operator!=(block_symmetry const &x) const { return !operator==(x); }
+    };
+
+    /**
+     * A block_gf (Arity = 1) or block2_gf (Arity = 2) storing only its unique blocks, and for each block
+     * the symmetry which gives it from a unique block (equal, conjugate, transposed, or zero).
+     *
+     * The arithmetic, the MPI reductions (mpi_foreach_payload) and the h5 io act on the unique blocks only.
+     * The blocks are numbered in the order of the block_gf, i.e. row major for a block2_gf.
+     *
+     * As the conjugation does not commute with the multiplication by a complex number, *= and /= by a non real number
+     * are forbidden if one of the symmetries contains a conjugation.
+     */
+    template <typename Var, typename Target = matrix_valued, int Arity = 1> class symmetric_block_gf {
+      static_assert(Arity == 1 or Arity == 2, "symmetric_block_gf : Arity is 1 or 2");
+
+      public:
+      using g_t            = gf<Var, Target>;
+      using mesh_t         = typename g_t::mesh_t;
+      using target_shape_t = typename g_t::target_shape_t;
+      using block_gf_t     = std::conditional_t<Arity == 1, block_gf<Var, Target>, block2_gf<Var, Target>>;
+      using block_names_t  = typename block_gf_t::block_names_t;
+
+      static constexpr bool is_complex    = triqs::is_complex<typename g_t::scalar_t>::value;
+      static constexpr bool can_transpose = (Target::rank == 2);
+      static constexpr int arity          = Arity;
+
+      private:
+      block_names_t _block_names;
+      std::vector<g_t> _unique;
+      std::vector<block_symmetry> _symmetries;
+      std::vector<std::pair<mesh_t, target_shape_t>> _zero_layouts;
+
+      public:
+      symmetric_block_gf() = default;
+
+      /**
+       * From the unique blocks and the symmetries.
+       *
+       * @param block_names The names of the blocks, as in the block_gf
+       * @param unique_blocks The unique blocks
+       * @param symmetries For each block, its source in unique_blocks and the operation. A zero block has no source.
+       * @param zero_layout The mesh and target shape of the zero blocks, if any
+       */
+      symmetric_block_gf(block_names_t block_names, std::vector<g_t> unique_blocks, std::vector<block_symmetry> symmetries,
+                         std::optional<std::pair<mesh_t, target_shape_t>> zero_layout = {})
+         : _block_names(std::move(block_names)), _unique(std::move(unique_blocks)), _symmetries(std::move(symmetries)) {
+        if (zero_layout) _zero_layouts.push_back(std::move(*zero_layout));
+        for (auto &s : _symmetries)
+          if (s.op == block_op::zero) s.source = 0;
+        _check();
+      }
+
+      /**
+       * From a block_gf, finding its symmetries.
+       *
+       * Each block is compared to the unique blocks already found : it is zero, equal, conjugate, transposed or
+       * conjugate transposed to one of them within precision (max norm of the difference of the data), or a new unique block.
+       *
+       * @param g The block_gf or block2_gf
+       * @param precision Tolerance of the comparisons
+       */
+      explicit symmetric_block_gf(block_gf_t const &g, double precision = 1.e-12) : _block_names(g.block_names()) {
+        _for_each_block(g, [&](g_t const &b) { _symmetries.push_back(_find_symmetry(b, precision)); });
+      }
+
+      /// Number of blocks
+      int size() const { return _symmetries.size(); }
+
+      /// Number of unique blocks
+      int n_unique() const { return _unique.size(); }
+
+      /// The names of the blocks
+      block_names_t const &block_names() const { return _block_names; }
+
+      /// The unique blocks. They may be modified in place, the other blocks follow.
+      std::vector<g_t> &unique_blocks() { return _unique; }
+      std::vector<g_t> const &unique_blocks() const { return _unique; }
+
+      /// The symmetry of each block
+      std::vector<block_symmetry> const &symmetries() const { return _symmetries; }
+
+      /// The n-th block, computed from its source
+      g_t block(int n) const {
+        auto const &s = _symmetries.at(n);
+        if (s.op == block_op::zero) {
+          auto const &[m, shape] = _zero_layouts[s.source];
+          g_t r{m, shape};
+          r.data() = 0;
+          return r;
+        }
+        g_t r = _unique[s.source];
+        if (s.op == block_op::conjugate or s.op == block_op::conjugate_transpose) _conj_in_place(r);
+        if (s.op == block_op::transpose or s.op == block_op::conjugate_transpose) _transpose_in_place(r);
+        return r;
+      }
+
+      /// The block (i, j) of a block2_gf
+      g_t block(int i, int j) const {
+        static_assert(Arity == 2, "block(i,j) is for a symmetric block2_gf");
+        return block(i * _block_names[1].size() + j);
+      }
+
+      /// The full block_gf
+      block_gf_t to_block_gf() const {
+        if constexpr (Arity == 1) {
+          std::vector<g_t> v;
+          v.reserve(size());
+          for (int n = 0; n < size(); ++n) v.push_back(block(n));
+          return {_block_names, std::move(v)};
+        } else {
+          int s1 = _block_names[0].size(), s2 = _block_names[1].size();
+          std::vector<std::vector<g_t>> v(s1);
+          for (int i = 0; i < s1; ++i)
+            for (int j = 0; j < s2; ++j) v[i].push_back(block(i, j));
+          return {_block_names, std::move(v)};
+        }
+      }
+
+      // ------------------------- Arithmetic on the unique blocks --------------------------
+
+      symmetric_block_gf &operator+=(symmetric_block_gf const &x) {
+        _check_same_symmetries(x);
+        for (int u = 0; u < n_unique(); ++u) _unique[u].data() += x._unique[u].data();
+        return *this;
+      }
+
+      symmetric_block_gf &operator-=(symmetric_block_gf const &x) {
+        _check_same_symmetries(x);
+        for (int u = 0; u < n_unique(); ++u) _unique[u].data() -= x._unique[u].data();
+        return *this;
+      }
+
+      template <typename S> std::enable_if_t<is_scalar<S>::value, symmetric_block_gf &> operator*=(S const &x) {
+        _check_scalar(x);
+        for (auto &g : _unique) g.data() *= x;
+        return *this;
+      }
+
+      template <typename S> std::enable_if_t<is_scalar<S>::value, symmetric_block_gf &> operator/=(S const &x) {
+        _check_scalar(x);
+        for (auto &g : _unique) g.data() /= x;
+        return *this;
+      }
+
+      friend symmetric_block_gf operator+(symmetric_block_gf x, symmetric_block_gf const &y) { return x += y; }
+      friend symmetric_block_gf operator-(symmetric_block_gf x, symmetric_block_gf const &y) { return x -= y; }
+
+      template <typename S> friend std::enable_if_t<is_scalar<S>::value, symmetric_block_gf> operator*(symmetric_block_gf x, S const &s) {
+        return x *= s;
+      }
+      template <typename S> friend std::enable_if_t<is_scalar<S>::value, symmetric_block_gf> operator*(S const &s, symmetric_block_gf x) {
+        return x *= s;
+      }
+      template <typename S> friend std::enable_if_t<is_scalar<S>::value, symmetric_block_gf> operator/(symmetric_block_gf x, S const &s) {
+        return x /= s;
+      }
+
+      // ------------------------- MPI --------------------------
+
+      /// The numbers of the unique blocks, for the packed and non-blocking reductions (cf mpi/vector.hpp)
+      template <typename F> friend void mpi_foreach_payload(symmetric_block_gf &g, F const &f) { mpi::mpi_foreach_payload(g._unique, f); }
+
+      /// Reduce the unique blocks in place, in a single packed message. The symmetries must be the same on all nodes.
+      friend void mpi_reduce_in_place(symmetric_block_gf &g, mpi::communicator c = {}, int root = 0, bool all = false, MPI_Op op = MPI_SUM) {
+        mpi::detail::reduce_in_place_packed(g, c, root, all, op);
+      }
+
+      /// Broadcast the unique blocks. The symmetries must be the same on all nodes.
+      friend void mpi_broadcast(symmetric_block_gf &g, mpi::communicator c = {}, int root = 0) {
+        for (auto &x : g._unique) mpi::broadcast(x.data(), c, root);
+      }
+
+      // ------------------------- HDF5 --------------------------
+
+      static std::string hdf5_scheme() { return (Arity == 1 ? "SymmetricBlockGf" : "SymmetricBlock2Gf"); }
+
+      /// Write the block names, the symmetries and the unique blocks
+      friend void h5_write(h5::group fg, std::string const &subgroup_name, symmetric_block_gf const &g) {
+        auto gr = fg.create_group(subgroup_name);
+        gr.write_hdf5_scheme(g);
+        if constexpr (Arity == 1)
+          h5_write(gr, "block_names", g._block_names);
+        else {
+          h5_write(gr, "block_names1", g._block_names[0]);
+          h5_write(gr, "block_names2", g._block_names[1]);
+        }
+        std::vector<long> sources, ops;
+        for (auto const &s : g._symmetries) {
+          sources.push_back(s.source);
+          ops.push_back(long(s.op));
+        }
+        h5_write(gr, "sources", sources);
+        h5_write(gr, "ops", ops);
+        h5_write(gr, "unique_blocks", g._unique);
+        h5_write(gr, "n_zero_layouts", long(g._zero_layouts.size()));
+        for (int k = 0; k < g._zero_layouts.size(); ++k) {
+          auto const &[m, shape] = g._zero_layouts[k];
+          h5_write(gr, "zero_mesh_" + std::to_string(k), m);
+          std::vector<long> sh(Target::rank);
+          for (int r = 0; r < Target::rank; ++r) sh[r] = shape[r];
+          h5_write(gr, "zero_shape_" + std::to_string(k), sh);
+        }
+      }
+
+      /// Read from HDF5
+      friend void h5_read(h5::group fg, std::string const &subgroup_name, symmetric_block_gf &g) {
+        auto gr = fg.open_group(subgroup_name);
+        gr.assert_hdf5_scheme(g);
+        if constexpr (Arity == 1)
+          h5_read(gr, "block_names", g._block_names);
+        else {
+          g._block_names.resize(2);
+          h5_read(gr, "block_names1", g._block_names[0]);
+          h5_read(gr, "block_names2", g._block_names[1]);
+        }
+        auto sources = h5::h5_read<std::vector<long>>(gr, "sources");
+        auto ops     = h5::h5_read<std::vector<long>>(gr, "ops");
+        if (sources.size() != ops.size()) TRIQS_RUNTIME_ERROR << "h5_read of a symmetric_block_gf : sources and ops differ in size";
+        g._symmetries.clear();
+        for (int n = 0; n < sources.size(); ++n) g._symmetries.push_back({sources[n], block_op(ops[n])});
+        h5_read(gr, "unique_blocks", g._unique);
+        g._zero_layouts.clear();
+        long n_zero = h5::h5_read<long>(gr, "n_zero_layouts");
+        for (int k = 0; k < n_zero; ++k) {
+          auto m     = h5::h5_read<mesh_t>(gr, "zero_mesh_" + std::to_string(k));
+          auto shape = h5::h5_read<std::vector<long>>(gr, "zero_shape_" + std::to_string(k));
+          if (shape.size() != Target::rank) TRIQS_RUNTIME_ERROR << "h5_read of a symmetric_block_gf : the target shape has the wrong rank";
+          target_shape_t sh;
+          for (int r = 0; r < Target::rank; ++r) sh[r] = shape[r];
+          g._zero_layouts.emplace_back(std::move(m), sh);
+        }
+        g._check();
+      }
+
+      private:
+      template <typename F> static void _for_each_block(block_gf_t const &g, F f) {
+        if constexpr (Arity == 1)
+          for (int i = 0; i < g.size(); ++i) f(g[i]);
+        else
+          for (int i = 0; i < g.size1(); ++i)
+            for (int j = 0; j < g.size2(); ++j) f(g(i, j));
+      }
+
+      static void _conj_in_place(g_t &g) {
+        if constexpr (is_complex) g.data() = conj(g.data());
+      }
+
+      static void _transpose_in_place(g_t &g) {
+        if constexpr (can_transpose) {
+          for (auto const &x : g.mesh()) {
+            arrays::matrix<typename g_t::scalar_t> m = g[x];
+            g[x]                                     = m.transpose();
+          }
+        }
+      }
+
+      static bool _is_square(g_t const &g) {
+        if constexpr (can_transpose)
+          return g.target_shape()[0] == g.target_shape()[1];
+        else
+          return false;
+      }
+
+      static bool _close(g_t const &a, g_t const &b, double precision) { return max_element(abs(a.data() - b.data())) <= precision; }
+
+      block_symmetry _find_symmetry(g_t const &b, double precision) {
+        if (b.data().size() == 0 or max_element(abs(b.data())) <= precision) {
+          for (int k = 0; k < _zero_layouts.size(); ++k)
+            if (_zero_layouts[k].first == b.mesh() and _zero_layouts[k].second == b.target_shape()) return {k, block_op::zero};
+          _zero_layouts.emplace_back(b.mesh(), b.target_shape());
+          return {long(_zero_layouts.size()) - 1, block_op::zero};
+        }
+        for (int u = 0; u < n_unique(); ++u) {
+          auto const &g = _unique[u];
+          if (!(g.mesh() == b.mesh()) or g.target_shape() != b.target_shape()) continue;
+          if (_close(g, b, precision)) return {u, block_op::identity};
+          if (is_complex) {
+            g_t c = g;
+            _conj_in_place(c);
+            if (_close(c, b, precision)) return {u, block_op::conjugate};
+          }
+          if (_is_square(g)) {
+            g_t t = g;
+            _transpose_in_place(t);
+            if (_close(t, b, precision)) return {u, block_op::transpose};
+            if (is_complex) {
+              _conj_in_place(t);
+              if (_close(t, b, precision)) return {u, block_op::conjugate_transpose};
+            }
+          }
+        }
+        _unique.push_back(b);
+        return {long(_unique.size()) - 1, block_op::identity};
+      }
+
+      void _check() const {
+        long n_blocks = 0;
+        if constexpr (Arity == 1)
+          n_blocks = _block_names.size();
+        else
+          n_blocks = (_block_names.size() == 2 ? _block_names[0].size() * _block_names[1].size() : 0);
+        if (n_blocks != size())
+          TRIQS_RUNTIME_ERROR << "symmetric_block_gf : " << size() << " symmetries given for " << n_blocks << " blocks";
+        for (auto const &s : _symmetries) {
+          long n_sources = (s.op == block_op::zero ? _zero_layouts.size() : _unique.size());
+          if (s.source < 0 or s.source >= n_sources) TRIQS_RUNTIME_ERROR << "symmetric_block_gf : invalid source " << s.source;
+          bool tr = (s.op == block_op::transpose or s.op == block_op::conjugate_transpose);
+          if (tr and !_is_square(_unique[s.source]))
+            TRIQS_RUNTIME_ERROR << "symmetric_block_gf : transposition of a block whose target is not a square matrix";
+        }
+      }
+
+      void _check_same_symmetries(symmetric_block_gf const &x) const {
+        if (_symmetries != x._symmetries or n_unique() != x.n_unique())
+          TRIQS_RUNTIME_ERROR << "symmetric_block_gf : arithmetic between objects with different symmetries";
+      }
+
+      template <typename S> void _check_scalar(S const &x) const {
+        if constexpr (triqs::is_complex<S>::value) {
+          if (x.imag() == 0) return;
+          for (auto const &s : _symmetries)
+            if (s.op == block_op::conjugate or s.op == block_op::conjugate_transpose)
+              TRIQS_RUNTIME_ERROR << "symmetric_block_gf : multiplication by a complex number of an object with conjugation symmetries";
+        }
+      }
+    };
+
+    /// A block2_gf storing only its unique blocks
+    template <typename Var, typename Target = matrix_valued> using symmetric_block2_gf = symmetric_block_gf<Var, Target, 2>;
+
+  } // namespace gfs
+} // namespace triqs
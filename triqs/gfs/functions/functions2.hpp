@@ -23,6 +23,7 @@
 #pragma once
 #include "../meshes/product.hpp"
 #include <itertools/itertools.hpp>
+#include <triqs/arrays/linalg/batched_inverse.hpp>
 
 namespace triqs::gfs {
 
@@ -55,6 +56,39 @@ namespace triqs::gfs {
     }
   }
 
+  namespace detail {
+
+    // The mesh on which the tail is fitted
+    template <int N, typename G> auto const &tail_fit_mesh(G const &g) {
+      if constexpr (std::is_base_of_v<tag::composite, typename G::mesh_t>)
+        return std::get<N>(g.mesh());
+      else
+        return g.mesh();
+    }
+
+    // Fit the tails of all blocks with a single least-squares solve.
+    // Only possible if the blocks share the fitting mesh, the fit parameters and the data shape.
+    template <bool enforce_hermiticity, int N, typename BG, typename BA>
+    std::optional<std::pair<std::vector<typename BG::g_t::data_t::regular_type>, double>>
+    fit_tail_batched(BG const &bg, BA const &known_moments, std::optional<long> inner_matrix_dim = {}) {
+      constexpr int R   = BG::g_t::data_rank;
+      constexpr int pos = std::is_base_of_v<tag::composite, typename BG::g_t::mesh_t> ? N : 0;
+
+      if (bg.size() < 2) return {};
+      auto const &m0 = tail_fit_mesh<N>(bg[0]);
+      std::vector<array_const_view<dcomplex, R>> g_data_vec, km_vec;
+      for (auto const &g_bl : bg) {
+        auto const &m = tail_fit_mesh<N>(g_bl);
+        if (!(m == m0) or !m.get_tail_fitter().has_same_parameters(m0.get_tail_fitter())) return {};
+        if (g_bl.data().shape() != bg[0].data().shape()) return {};
+        g_data_vec.push_back(make_const_view(g_bl.data()));
+      }
+      for (auto const &km : known_moments) km_vec.push_back(make_const_view(km));
+
+      return m0.get_tail_fitter().template fit_batch<enforce_hermiticity>(m0, g_data_vec, pos, true, km_vec, inner_matrix_dim);
+    }
+  } // namespace detail
+
   /**
    * Fit the tail of a Block Green function using a least-squares fitting procedure
    *
@@ -66,6 +100,7 @@ namespace triqs::gfs {
   template <int N = 0, typename BG, typename BA = std::vector<typename BG::g_t::data_t::regular_type>>
   std::pair<std::vector<typename BG::g_t::data_t::regular_type>, double> fit_tail(BG const &bg, BA const &known_moments = {})
      REQUIRES(is_block_gf_v<BG, 1>) {
+    if (auto res = detail::fit_tail_batched<false, N>(bg, known_moments)) return std::move(*res);
     double max_err = 0.0;
     std::vector<typename BG::g_t::data_t::regular_type> tail_vec;
     for (auto [i, g_bl] : itertools::enumerate(bg)) {
@@ -119,6 +154,14 @@ namespace triqs::gfs {
    */
   template <int N = 0, typename BG, typename A = std::vector<typename BG::g_t::data_t::regular_type>>
   std::pair<std::vector<typename BG::g_t::data_t::regular_type>, double> fit_hermitian_tail(BG const &bg, A const &known_moments = {}) REQUIRES(is_block_gf_v<BG, 1>) {
+    std::optional<long> inner_matrix_dim;
+    if constexpr (BG::g_t::target_t::rank == 0)
+      inner_matrix_dim = 1;
+    else if constexpr (BG::g_t::target_t::rank == 2) {
+      if (bg.size() > 0 and bg[0].target_shape()[0] == bg[0].target_shape()[1]) inner_matrix_dim = bg[0].target_shape()[0];
+    }
+    if (inner_matrix_dim)
+      if (auto res = detail::fit_tail_batched<true, N>(bg, known_moments, inner_matrix_dim)) return std::move(*res);
     double max_err = 0.0;
     std::vector<typename BG::g_t::data_t::regular_type> tail_vec;
     for (auto [i, g_bl] : itertools::enumerate(bg)) {
@@ -191,17 +234,15 @@ namespace triqs::gfs {
   *-----------------------------------------------------------------------------------------------------*/
 
   // auxiliary function : invert the data : one function for all matrix valued gf (save code).
-  template <typename A3> void _gf_invert_data_in_place(A3 &&a) {
-    auto dom = a(ellipsis(), 0, 0).indexmap().domain();
-    auto f   = [&a, _ = itertools::range()](auto... x) { return a(x..., _, _); };
-    for (auto ind : dom) {
-      auto v = make_matrix_view(triqs::tuple::apply(f, ind));
-      v      = triqs::arrays::inverse(v);
-    }
-  }
+  template <typename A3> void _gf_invert_data_in_place(A3 &&a) { triqs::arrays::inverse_in_place_batched(make_view(a)); }
 
   template <typename M> void invert_in_place(gf_view<M, matrix_valued> g) { _gf_invert_data_in_place(g.data()); }
 
+  // Invert in place a gf whose target matrices are block diagonal, with consecutive diagonal blocks of the given sizes
+  template <typename M> void invert_in_place(gf_view<M, matrix_valued> g, std::vector<long> const &block_sizes) {
+    triqs::arrays::inverse_in_place_batched(g.data(), block_sizes);
+  }
+
   template <typename M> gf<M, matrix_valued> inverse(gf<M, matrix_valued> const &g) {
     auto res                    = g;
     gf_view<M, matrix_valued> v = res;
@@ -215,6 +256,15 @@ namespace triqs::gfs {
 
   template <typename M> gf<M, matrix_valued> inverse(gf_const_view<M, matrix_valued> g) { return inverse(gf<M, matrix_valued>(g)); }
 
+  // Inverse of an expression, e.g. inverse(G0inv - Sigma) : the expression is evaluated directly into the result
+  // (in a single pass when possible, cf gf_expr.hpp) which is then inverted in place. No other gf is allocated.
+  template <typename E> gf<typename E::variable_t, matrix_valued> inverse(E const &e) REQUIRES(is_gf_expr<E>::value) {
+    static_assert(std::is_same_v<typename E::target_t, matrix_valued>, "inverse : the expression must be matrix_valued");
+    gf<typename E::variable_t, matrix_valued> res = e;
+    invert_in_place(res());
+    return res;
+  }
+
   /*------------------------------------------------------------------------------------------------------
   *                     is_gf_real : true iif the gf is real
   *-----------------------------------------------------------------------------------------------------*/
@@ -252,6 +302,12 @@ namespace triqs::gfs {
     return {g.mesh(), transposed_view(g.data(), 0, 2, 1), g.indices().transpose()};
   }
 
+  template <typename E> gf<typename E::variable_t, matrix_valued> transpose(E const &e) REQUIRES(is_gf_expr<E>::value) {
+    static_assert(std::is_same_v<typename E::target_t, matrix_valued>, "transpose : the expression must be matrix_valued");
+    gf<typename E::variable_t, matrix_valued> res = e;
+    return transpose(res());
+  }
+
   /*------------------------------------------------------------------------------------------------------
   *                      Conjugate
   *-----------------------------------------------------------------------------------------------------*/
@@ -261,13 +317,38 @@ namespace triqs::gfs {
     return {g.mesh(), conj(g.data()), g.indices()};
   }
 
+  // Conjugate of an expression : evaluated into the result, conjugated in place
+  template <typename E> gf<typename E::variable_t, typename E::target_t> conj(E const &e) REQUIRES(is_gf_expr<E>::value) {
+    gf<typename E::variable_t, typename E::target_t> res = e;
+    res.data()                                            = conj(res.data());
+    return res;
+  }
+
   /*------------------------------------------------------------------------------------------------------
   *                      Multiply by matrices left or right
   *-----------------------------------------------------------------------------------------------------*/
 
-  // FIXME : speed issue ? direct gemm
-  //
   template <typename A3, typename T> void _gf_data_mul_R(A3 &&a, matrix<T> const &r) {
+    using V = typename std::decay_t<A3>::value_type;
+    // Contiguous C ordered data of shape (N, n, m) : a single product of the (N * n, m) matrix by r
+    if constexpr (std::is_same_v<V, T> and is_blas_lapack_type<T>::value) {
+      auto const &st = a.indexmap().strides();
+      long n = second_dim(a), m = third_dim(a);
+      if (st[2] == 1 and st[1] == m and st[0] == n * m and first_dim(r) == m and second_dim(r) == m) {
+        long N = first_dim(a) * n;
+        matrix_view<T> v{{mini_vector<size_t, 2>(N, m), mini_vector<std::ptrdiff_t, 2>(m, 1), std::ptrdiff_t(a.indexmap().start_shift())}, a.storage()};
+        // gemm can not be done in place : the rows are multiplied by blocks into a bounded scratch buffer, and copied back
+        long n_rows = std::min(N, std::max(1l, (1l << 16) / m));
+        matrix<T> scratch(n_rows, m);
+        for (long r0 = 0; r0 < N; r0 += n_rows) {
+          auto R  = itertools::range(r0, std::min(r0 + n_rows, N));
+          auto sc = scratch(itertools::range(0, R.size()), itertools::range());
+          blas::gemm(1, v(R, itertools::range()), r, 0, sc);
+          v(R, itertools::range()) = sc;
+        }
+        return;
+      }
+    }
     for (int i = 0; i < first_dim(a); ++i) { // Rely on the ordering
       matrix_view<T> v = a(i, itertools::range(), itertools::range());
       v                = v * r;
@@ -275,6 +356,21 @@ namespace triqs::gfs {
   }
 
   template <typename A3, typename T> void _gf_data_mul_L(matrix<T> const &l, A3 &&a) {
+    using V = typename std::decay_t<A3>::value_type;
+    // The blocks (n, m) of the data are not a single matrix for a product on the left : one gemm per block,
+    // into the same scratch buffer, without a temporary per mesh point.
+    if constexpr (std::is_same_v<V, T> and is_blas_lapack_type<T>::value) {
+      long n = second_dim(a), m = third_dim(a);
+      if (first_dim(l) == n and second_dim(l) == n) {
+        matrix<T> scratch(n, m);
+        for (long i = 0; i < first_dim(a); ++i) {
+          matrix_view<T> v = a(i, itertools::range(), itertools::range());
+          blas::gemm(1, l, v, 0, scratch);
+          v = scratch;
+        }
+        return;
+      }
+    }
     for (int i = 0; i < first_dim(a); ++i) { // Rely on the ordering
       matrix_view<T> v = a(i, itertools::range(), itertools::range());
       v                = l * v;
@@ -0,0 +1,162 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <triqs/utility/time_pt.hpp>
+#include <vector>
+
+namespace triqs {
+  namespace gfs {
+
+    /**
+     * A read-only cubic spline interpolation of a gf<imtime>, for fast evaluation at arbitrary times.
+     *
+     * The spline is C2, with not-a-knot conditions at both ends (no assumption on the derivatives in 0 and beta).
+     * Its error is O(delta_tau^4), instead of O(delta_tau^2) for the linear interpolation of the gf itself.
+     *
+     * The coefficients are stored per segment of the mesh, and for each power of (tau - tau_k), contiguously for all the
+     * elements of the target : the evaluation of all the elements at one time is a single vectorizable loop.
+     *
+     * The spline is a copy : it does not change when the gf is modified later.
+     */
+    template <typename Target = matrix_valued> class imtime_spline {
+      using T              = typename Target::scalar_t;
+      static constexpr int R = Target::rank;
+
+      double _beta = 0, _inv_delta = 0;
+      long _n_seg = 0, _n_elem = 0;
+      arrays::mini_vector<int, R> _target_shape;
+      arrays::array<T, 3> _coefs; // (segment k, power p, element e) : (tau - tau_k)^p / delta^p coefficient
+
+      public:
+      imtime_spline() = default;
+
+      /// Build the spline from the values of g on its mesh. The mesh must have at least 4 points.
+      imtime_spline(gf_const_view<imtime, Target> g) {
+        auto const &m = g.mesh();
+        long n        = m.size();
+        if (n < 4) TRIQS_RUNTIME_ERROR << "imtime_spline : the mesh must have at least 4 points, it has " << n;
+        _beta         = m.domain().beta;
+        _inv_delta    = 1 / m.delta();
+        _n_seg        = n - 1;
+        _target_shape = g.target_shape();
+        _n_elem       = _target_shape.product_of_elements();
+
+        // y(i, e) : the values on the mesh, in C order
+        arrays::array<T, R + 1> d = g.data();
+        arrays::matrix_const_view<T> y{{arrays::mini_vector<size_t, 2>(n, _n_elem)}, nda::mem::handle<T, 'B'>{d.data_start(), size_t(n * _n_elem)}};
+
+        // Second derivatives M (in units of delta^-2) :
+        //   M_{i-1} + 4 M_i + M_{i+1} = 6 (y_{i-1} - 2 y_i + y_{i+1}),  i = 1 ... n-2
+        // Not-a-knot (M_0 - 2 M_1 + M_2 = 0, same at the other end) reduces the first and last equations to 6 M_1 = ...
+        // The matrix is the same for all elements : the Thomas algorithm is done once, and applied to all of them.
+        arrays::matrix<T> M(n, _n_elem);
+        auto rhs = [&y](long i, long e) { return 6 * (y(i - 1, e) - 2 * y(i, e) + y(i + 1, e)); };
+        for (long e = 0; e < _n_elem; ++e) {
+          M(1, e)     = rhs(1, e) / 6;
+          M(n - 2, e) = rhs(n - 2, e) / 6;
+        }
+        // rows i = 2 ... n-3, forward elimination then back substitution
+        std::vector<double> cp(n, 0);
+        for (long i = 2; i < n - 2; ++i) {
+          double denom = 4 - (i > 2 ? cp[i - 1] : 0);
+          cp[i]        = 1 / denom;
+          for (long e = 0; e < _n_elem; ++e) {
+            T r = rhs(i, e) - (i > 2 ? M(i - 1, e) : M(1, e)) - (i == n - 3 ? M(n - 2, e) : T(0));
+            M(i, e) = r / denom;
+          }
+        }
+        for (long i = n - 4; i >= 2; --i)
+          for (long e = 0; e < _n_elem; ++e) M(i, e) -= cp[i] * M(i + 1, e);
+        for (long e = 0; e < _n_elem; ++e) {
+          M(0, e)     = 2 * M(1, e) - M(2, e);
+          M(n - 1, e) = 2 * M(n - 2, e) - M(n - 3, e);
+        }
+
+        _coefs.resize(_n_seg, 4, _n_elem);
+        for (long k = 0; k < _n_seg; ++k)
+          for (long e = 0; e < _n_elem; ++e) {
+            _coefs(k, 0, e) = y(k, e);
+            _coefs(k, 1, e) = y(k + 1, e) - y(k, e) - (2 * M(k, e) + M(k + 1, e)) / 6;
+            _coefs(k, 2, e) = M(k, e) / 2;
+            _coefs(k, 3, e) = (M(k + 1, e) - M(k, e)) / 6;
+          }
+      }
+
+      /// The shape of the target
+      arrays::mini_vector<int, R> const &target_shape() const { return _target_shape; }
+
+      /// Evaluate all the elements at tau, into out (C ordered, of size the number of elements of the target)
+      void evaluate(double tau, T *out) const {
+        double x = tau * _inv_delta;
+        long k   = std::floor(x);
+        if (k == _n_seg) --k; // tau = beta
+        if (k == -1) k = 0;   // rounding error below 0
+        if (k < 0 or k >= _n_seg or x < -1.e-8 or x > _n_seg + 1.e-8)
+          TRIQS_RUNTIME_ERROR << "imtime_spline : tau = " << tau << " is out of [0, " << _beta << "]";
+        double t    = x - k;
+        T const *a  = &_coefs(k, 0, 0);
+        T const *b  = a + _n_elem;
+        T const *c  = b + _n_elem;
+        T const *d  = c + _n_elem;
+        for (long e = 0; e < _n_elem; ++e) out[e] = a[e] + t * (b[e] + t * (c[e] + t * d[e]));
+      }
+
+      /// Value at tau
+      typename Target::value_t operator()(double tau) const {
+        if constexpr (R == 0) {
+          T r;
+          evaluate(tau, &r);
+          return r;
+        } else {
+          typename Target::value_t r(_target_shape);
+          evaluate(tau, r.data_start());
+          return r;
+        }
+      }
+
+      /// Value at tau
+      typename Target::value_t operator()(utility::time_pt const &tau) const { return operator()(double(tau)); }
+
+      /// Values at all the tau : an array (tau index, target indices...)
+      arrays::array<T, R + 1> operator()(arrays::array_const_view<double, 1> taus) const {
+        return _evaluate_batch(taus.size(), [&taus](long i) { return taus(i); });
+      }
+
+      /// Values at all the tau : an array (tau index, target indices...)
+      arrays::array<T, R + 1> operator()(std::vector<utility::time_pt> const &taus) const {
+        return _evaluate_batch(taus.size(), [&taus](long i) { return double(taus[i]); });
+      }
+
+      private:
+      template <typename F> arrays::array<T, R + 1> _evaluate_batch(long n, F tau) const {
+        arrays::mini_vector<size_t, R + 1> shape;
+        shape[0] = n;
+        for (int r = 0; r < R; ++r) shape[r + 1] = _target_shape[r];
+        arrays::array<T, R + 1> res(shape);
+        for (long i = 0; i < n; ++i) evaluate(tau(i), res.data_start() + i * _n_elem);
+        return res;
+      }
+    };
+
+    /// Cubic spline of g (cf imtime_spline)
+    template <typename G> imtime_spline<typename G::target_t> make_imtime_spline(G const &g) { return {g}; }
+  } // namespace gfs
+} // namespace triqs
@@ -91,6 +91,12 @@ namespace triqs {
 
     template <typename G> TRIQS_DEPRECATED("use X.target_shape() instead") auto get_target_shape(G const &g) { return g.target_shape(); }
 
+    // Fused evaluation of expressions on the data, cf gf_expr.hpp
+    namespace gfs_expr_tools {
+      template <typename E> struct is_fusable;
+      template <typename E> auto data_expr(E const &e);
+    } // namespace gfs_expr_tools
+
     /*------------------------------------------------------------------------------------------------------
  *                                  For mpi lazy
  *-----------------------------------------------------------------------------------------------------*/
@@ -61,6 +61,9 @@ namespace triqs::gfs {
     is_instantiation_of_v<gf_const_view, G>;
   template <typename G> inline constexpr bool is_gf_v<G, typename std::decay_t<G>::variable_t> = is_gf_v<G, void>;
 
+  /// The numbers of a Green function, for the packed reduction of containers of gf (cf mpi/vector.hpp)
+  template <typename G, typename F> std::enable_if_t<is_gf_v<G>> mpi_foreach_payload(G &&g, F const &f) { mpi_foreach_payload(g.data(), f); }
+
   /// ---------------------------  implementation  ---------------------------------
 
   namespace details {
@@ -364,7 +367,12 @@ namespace triqs::gfs {
     template <typename RHS> gf &operator=(RHS &&rhs) REQUIRES(GreenFunction<RHS>::value) {
       _mesh = rhs.mesh();
       _data.resize(rhs.data_shape());
-      for (auto const &w : _mesh) (*this)[w] = rhs[w];
+      if constexpr (is_gf_v<RHS>) // same mesh : copy all the data at once
+        _data() = rhs.data();
+      else if constexpr (gfs_expr_tools::is_fusable<std::decay_t<RHS>>::value)
+        _data() = gfs_expr_tools::data_expr(rhs);
+      else
+        for (auto const &w : _mesh) (*this)[w] = rhs[w];
       _indices = rhs.indices();
       if (_indices.empty()) _indices = indices_t(target_shape());
       //if (not _indices.has_shape(target_shape())) _indices = indices_t(target_shape());
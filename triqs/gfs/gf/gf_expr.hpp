@@ -119,6 +119,7 @@ namespace triqs {
     } // namespace gfs_expr_tools
 
     template <typename Tag, typename L, typename R> struct gf_expr : TRIQS_CONCEPT_TAG_NAME(GreenFunction) {
+      using tag_t      = Tag;
       using L_t        = typename std::remove_reference<L>::type;
       using R_t        = typename std::remove_reference<R>::type;
       using variable_t = typename gfs_expr_tools::_or_<typename L_t::variable_t, typename R_t::variable_t>::type;
@@ -168,6 +169,48 @@ namespace triqs {
     template <typename Tag, typename L, typename R> struct is_gf_expr<gf_expr<Tag, L, R>> : std::true_type {};
     template <typename L> struct is_gf_expr<gf_unary_m_expr<L>> : std::true_type {};
 
+    // -------------------------------------------------------------------
+    // Fused evaluation.
+    // When all the operations of an expression act element by element on the data of the gf
+    // (same point of the mesh, same element of the target), the expression is evaluated
+    // as an array expression on the data : a single pass through memory, without temporaries.
+    // It is not the case with matrix_valued targets for the product or quotient of two gf (matrix product, inverse),
+    // and for the sum of a gf and a scalar (added on the diagonal only).
+
+    namespace gfs_expr_tools {
+
+      template <typename E> struct is_scalar_wrap : std::false_type {};
+      template <typename S> struct is_scalar_wrap<scalar_wrap<S>> : std::true_type {};
+
+      template <typename E> struct is_fusable : std::integral_constant<bool, is_gf_v<E>> {};
+      template <typename S> struct is_fusable<scalar_wrap<S>> : std::true_type {};
+
+      template <typename L> struct is_fusable<gf_unary_m_expr<L>> : is_fusable<std::decay_t<L>> {};
+
+      template <typename Tag, typename L, typename R> struct is_fusable<gf_expr<Tag, L, R>> {
+        using L_t                    = std::decay_t<L>;
+        using R_t                    = std::decay_t<R>;
+        static constexpr bool matrix = gf_expr<Tag, L, R>::target_t::is_matrix;
+        static constexpr bool l_s = is_scalar_wrap<L_t>::value, r_s = is_scalar_wrap<R_t>::value;
+        static constexpr bool is_sum = std::is_same_v<Tag, utility::tags::plus> or std::is_same_v<Tag, utility::tags::minus>;
+        static constexpr bool op_ok =
+           (is_sum ? !(matrix and (l_s or r_s)) : std::is_same_v<Tag, utility::tags::multiplies> ? (!matrix or l_s or r_s) : (!matrix or r_s));
+        static constexpr bool value = op_ok and is_fusable<L_t>::value and is_fusable<R_t>::value;
+      };
+
+      // The array expression (or scalar) computing the data of e
+      template <typename E> auto data_expr(E const &e) {
+        if constexpr (is_scalar_wrap<E>::value)
+          return e.s;
+        else if constexpr (is_gf_v<E>)
+          return e.data()();
+        else if constexpr (is_instantiation_of_v<gf_unary_m_expr, E>)
+          return -data_expr(e.l);
+        else
+          return utility::operation<typename E::tag_t>()(data_expr(e.l), data_expr(e.r));
+      }
+    } // namespace gfs_expr_tools
+
 // -------------------------------------------------------------------
 // Now we can define all the C++ operators ...
 #define DEFINE_OPERATOR(TAG, OP, TRAIT1, TRAIT2)                                                                                                     \
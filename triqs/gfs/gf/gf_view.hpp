@@ -335,7 +335,14 @@ namespace triqs::gfs {
       for (auto const &w : g.mesh()) g[w] = rhs;
     } else {
       if (!(g.mesh() == rhs.mesh())) TRIQS_RUNTIME_ERROR << "Gf Assignment in View : incompatible mesh \n" << g.mesh() << "\n vs \n" << rhs.mesh();
-      for (auto const &w : g.mesh()) g[w] = rhs[w];
+      if constexpr (gfs_expr_tools::is_fusable<RHS>::value) { // a gf, or an expression acting element by element on the data
+        if (g.data_shape() != rhs.data_shape()) TRIQS_RUNTIME_ERROR << "Gf Assignment in View : incompatible target shape";
+        if constexpr (is_gf_v<RHS>)
+          g.data() = rhs.data();
+        else
+          g.data() = gfs_expr_tools::data_expr(rhs);
+      } else
+        for (auto const &w : g.mesh()) g[w] = rhs[w];
     }
   }
 } // namespace triqs::gfs
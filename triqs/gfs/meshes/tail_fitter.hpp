@@ -79,6 +79,15 @@ namespace triqs::gfs {
     arrays::matrix<dcomplex> _vander;
     std::vector<long> _fit_idx_lst;
 
+    // View of the elements col0, col0 + 1, ... of row i of a matrix, as an array of the given lengths
+    template <int R> static arrays::array_view<dcomplex, R> row_as_array(arrays::matrix<dcomplex> &mat, long i, long col0,
+                                                          utility::mini_vector<size_t, R> const &lengths) {
+      using imap_t = typename arrays::array_view<dcomplex, R>::indexmap_type;
+      auto strides = imap_t{typename imap_t::domain_type{lengths}}.strides(); // C ordering
+      for (int r = 0; r < R; ++r) strides[r] *= mat.indexmap().strides()[1];
+      return {imap_t{lengths, strides, std::ptrdiff_t(mat.indexmap()(i, col0))}, mat.storage()};
+    }
+
     public:
     tail_fitter(double tail_fraction, int n_tail_max, std::optional<int> expansion_order = {})
        : _tail_fraction(tail_fraction),
@@ -101,6 +110,12 @@ namespace triqs::gfs {
     // Return the tail_fraction
     double get_tail_fraction() const { return _tail_fraction; }
 
+    // Do two fitters use the same fitting parameters ?
+    bool has_same_parameters(tail_fitter const &x) const {
+      return _tail_fraction == x._tail_fraction and _n_tail_max == x._n_tail_max and _adjust_order == x._adjust_order
+         and _expansion_order == x._expansion_order;
+    }
+
     //----------------------------------------------------------------------------------------------
 
     // Return the vector of all indices that are used fit the fitting procedure
@@ -195,17 +210,61 @@ namespace triqs::gfs {
     template <bool enforce_hermiticity = false, typename M, int R, int R2 = R>
     std::pair<arrays::array<dcomplex, R>, double> fit(M const &m, array_const_view<dcomplex, R> g_data, int n, bool normalize,
                                                       array_const_view<dcomplex, R2> known_moments, std::optional<long> inner_matrix_dim = {}) {
+      static_assert((R == R2), "The rank of the moment array is not equal to the data to fit !!!");
+      std::vector<array_const_view<dcomplex, R>> km;
+      if (first_dim(known_moments) > 0) km.push_back(known_moments);
+      auto [res, epsilon] = fit_batch<enforce_hermiticity>(m, std::vector<array_const_view<dcomplex, R>>{g_data}, n, normalize, km, inner_matrix_dim);
+      return {std::move(res[0]), epsilon};
+    }
+
+    /**
+     * Fit the tails of several data arrays of identical shape, defined on the same mesh, at once.
+     *
+     * All non-frequency indices of all the arrays are treated as right-hand sides of a single
+     * least-squares problem, which is gathered and solved in one go.
+     *
+     * @param m mesh
+     * @param g_data_vec The data arrays
+     * @param n position of the omega in the data arrays
+     * @param normalize Finish the normalization of the tail coefficient (normally true)
+     * @param known_moments_vec Arrays of the known_moments, one per data array, or empty
+     * @return The moments for each data array, and the maximal fitting error
+     * */
+    template <bool enforce_hermiticity = false, typename M, int R>
+    std::pair<std::vector<arrays::array<dcomplex, R>>, double> fit_batch(M const &m, std::vector<array_const_view<dcomplex, R>> const &g_data_vec,
+                                                                         int n, bool normalize,
+                                                                         std::vector<array_const_view<dcomplex, R>> const &known_moments_vec,
+                                                                         std::optional<long> inner_matrix_dim = {}) {
 
       if (enforce_hermiticity and not inner_matrix_dim.has_value())
         TRIQS_RUNTIME_ERROR << "Enforcing the hermiticity in tail_fit requires inner matrix dimension";
       if constexpr (enforce_hermiticity)
         static_assert(std::is_same_v<typename M::var_t, imfreq>, "Enforcing the hermiticity in tail_fit requires Matsubara mesh");
-      static_assert((R == R2), "The rank of the moment array is not equal to the data to fit !!!");
       if (m.positive_only()) TRIQS_RUNTIME_ERROR << "Can not fit on a positive_only mesh";
+      if (g_data_vec.empty()) return {{}, 0.0};
+      if (!known_moments_vec.empty() and known_moments_vec.size() != g_data_vec.size())
+        TRIQS_RUNTIME_ERROR << "Number of known_moments arrays does not match the number of data arrays";
+
+      using triqs::arrays::ellipsis;
+      using itertools::enumerate;
+
+      // Shape of the data with the relevant mesh swapped to the front, common to all arrays
+      auto lg = rotate_index_view(g_data_vec[0], n).indexmap().lengths();
+      for (auto const &g_data : g_data_vec)
+        if (rotate_index_view(g_data, n).indexmap().lengths() != lg) TRIQS_RUNTIME_ERROR << "Batched tail fit requires data arrays of identical shape";
+      long ncols       = g_data_vec[0].size() / lg[0];
+      long ncols_total = ncols * g_data_vec.size();
 
       // If not set, build least square solver for for given number of known moments
-      int n_fixed_moments = first_dim(known_moments);
-      if (n_fixed_moments > _expansion_order) return {known_moments, 0.0};
+      int n_fixed_moments = known_moments_vec.empty() ? 0 : first_dim(known_moments_vec[0]);
+      for (auto const &km : known_moments_vec)
+        if (first_dim(km) != n_fixed_moments) TRIQS_RUNTIME_ERROR << "known_moments arrays must all have the same number of moments";
+
+      if (n_fixed_moments > _expansion_order) {
+        std::vector<arrays::array<dcomplex, R>> res;
+        for (auto const &km : known_moments_vec) res.emplace_back(km);
+        return {std::move(res), 0.0};
+      }
 
       auto &lss = get_lss<enforce_hermiticity>();
       if (!bool(lss[n_fixed_moments])) setup_lss<enforce_hermiticity>(m, n_fixed_moments);
@@ -213,44 +272,37 @@ namespace triqs::gfs {
       // Total number of moments
       int n_moments = lss[n_fixed_moments]->n_var() + n_fixed_moments;
 
-      using triqs::arrays::ellipsis;
-      using itertools::enumerate;
-
-      // The values of the Green function. Swap relevant mesh to front
-      auto g_data_swap_idx = rotate_index_view(g_data, n);
-      auto const &imp      = g_data_swap_idx.indexmap();
-      long ncols           = imp.size() / imp.lengths()[0];
-
-      // We flatten the data in the target space and remaining meshes into the second dim
-      arrays::matrix<dcomplex> g_mat(first_dim(_vander), ncols);
-
-      // Copy g_data into new matrix (necessary because g_data might have fancy strides/lengths)
-      for (auto [i, n] : enumerate(_fit_idx_lst)) {
-        if constexpr (R == 1)
-          g_mat(i, 0) = g_data_swap_idx(m.index_to_linear(n));
-        else
-          for (auto [j, x] : enumerate(g_data_swap_idx(m.index_to_linear(n), ellipsis()))) g_mat(i, j) = x;
+      // We flatten the data in the target space and remaining meshes into the second dim,
+      // and put the arrays side by side. Each row is filled by a single strided copy.
+      arrays::matrix<dcomplex> g_mat(first_dim(_vander), ncols_total);
+      for (auto [b, g_data] : enumerate(g_data_vec)) {
+        auto g_data_swap_idx = rotate_index_view(g_data, n);
+        for (auto [i, idx] : enumerate(_fit_idx_lst)) {
+          if constexpr (R == 1)
+            g_mat(i, b) = g_data_swap_idx(m.index_to_linear(idx));
+          else
+            row_as_array(g_mat, i, b * ncols, lg.front_pop()) = g_data_swap_idx(m.index_to_linear(idx), ellipsis());
+        }
       }
 
-      // If an array with known_moments was passed, flatten the array into a matrix
+      // If arrays with known_moments were passed, flatten them into a matrix
       // just like g_data. Then account for the proper shift in g_mat
       if (n_fixed_moments > 0) {
-        auto imp_km   = known_moments.indexmap();
-        long ncols_km = imp_km.size() / imp_km.lengths()[0];
-
-        if (ncols != ncols_km) TRIQS_RUNTIME_ERROR << "known_moments shape incompatible with shape of data";
-        arrays::matrix<dcomplex> km_mat(n_fixed_moments, ncols);
-
-        // We have to scale the known_moments by 1/Omega_max^n
-        double z = 1.0;
-	double om_max = std::abs(m.omega_max());
-
-        for (int order : range(n_fixed_moments)) {
-          if constexpr (R == 1)
-            km_mat(order, 0) = z * known_moments(order, ellipsis());
-          else
-            for (auto [n, x] : enumerate(known_moments(order, ellipsis()))) km_mat(order, n) = z * x;
-          z /= om_max;
+        arrays::matrix<dcomplex> km_mat(n_fixed_moments, ncols_total);
+        for (auto [b, known_moments] : enumerate(known_moments_vec)) {
+          if (known_moments.size() != n_fixed_moments * ncols) TRIQS_RUNTIME_ERROR << "known_moments shape incompatible with shape of data";
+
+          // We have to scale the known_moments by 1/Omega_max^n
+          double z      = 1.0;
+          double om_max = std::abs(m.omega_max());
+
+          for (int order : range(n_fixed_moments)) {
+            if constexpr (R == 1)
+              km_mat(order, b) = z * known_moments(order);
+            else
+              row_as_array(km_mat, order, b * ncols, lg.front_pop()) = z * known_moments(order, ellipsis());
+            z /= om_max;
+          }
         }
 
         // Shift g_mat to account for known moment correction
@@ -263,8 +315,8 @@ namespace triqs::gfs {
       // === The result a_mat contains the fitted moments divided by omega_max()^n
       // Here we extract the real moments
       if (normalize) {
-        double z = 1.0;
-	double om_max = std::abs(m.omega_max());
+        double z      = 1.0;
+        double om_max = std::abs(m.omega_max());
         for (int i : range(n_fixed_moments)) z *= om_max;
         for (int i : range(first_dim(a_mat))) {
           a_mat(i, range()) *= z;
@@ -272,21 +324,21 @@ namespace triqs::gfs {
         }
       }
 
-      // === Reinterpret the result as an R-dimensional array according to initial shape and return together with the error
-
-      using r_t = arrays::array<dcomplex, R>; // return type
-      auto lg   = g_data_swap_idx.indexmap().lengths();
-
-      // Index map for the view on the a_mat result
-      lg[0]     = n_moments - n_fixed_moments;
-      auto imp1 = typename r_t::indexmap_type{typename r_t::indexmap_type::domain_type{lg}};
-
-      // Index map for the full result
-      lg[0]    = n_moments;
-      auto res = r_t(typename r_t::indexmap_type::domain_type{lg});
-
-      if (n_fixed_moments) res(range(n_fixed_moments), ellipsis()) = known_moments;
-      res(range(n_fixed_moments, n_moments), ellipsis()) = typename r_t::view_type{imp1, a_mat.storage()};
+      // === Reinterpret the result as R-dimensional arrays according to initial shape and return together with the error
+      std::vector<arrays::array<dcomplex, R>> res;
+      res.reserve(g_data_vec.size());
+      lg[0] = n_moments;
+      for (long b : range(g_data_vec.size())) {
+        auto r = arrays::array<dcomplex, R>(typename arrays::array<dcomplex, R>::indexmap_type::domain_type{lg});
+        if (n_fixed_moments) r(range(n_fixed_moments), ellipsis()) = known_moments_vec[b];
+        for (int i : range(n_fixed_moments, n_moments)) {
+          if constexpr (R == 1)
+            r(i) = a_mat(i - n_fixed_moments, b);
+          else
+            r(i, ellipsis()) = row_as_array(a_mat, i - n_fixed_moments, b * ncols, lg.front_pop());
+        }
+        res.push_back(std::move(r));
+      }
 
       return {std::move(res), epsilon};
     }
@@ -22,42 +22,76 @@
 //#include "pade.hpp"
 #include <triqs/arrays.hpp>
 #include <triqs/utility/pade_approximants.hpp>
+#include <exception>
+#include <map>
+#include <vector>
 
 namespace triqs {
   namespace gfs {
 
     typedef std::complex<double> dcomplex;
 
-    void pade(gf_view<refreq> gr, gf_const_view<imfreq> gw, int n_points, double freq_offset) {
+    void pade(gf_view<refreq> gr, gf_const_view<imfreq> gw, int n_points, double freq_offset, bool adaptive_precision) {
 
       // make sure the GFs have the same structure
       //assert(gw.shape() == gr.shape());
 
-      gr() = 0.0;
-
       auto sh = gw.data().shape().front_pop();
       int N1 = sh[0], N2 = sh[1];
-      for (int n1 = 0; n1 < N1; n1++) {
-        for (int n2 = 0; n2 < N2; n2++) {
 
-          arrays::vector<dcomplex> z_in(n_points); // complex points
-          arrays::vector<dcomplex> u_in(n_points); // values at these points
+      // Input points and evaluation points are common to all elements
+      arrays::vector<dcomplex> z_in(n_points);
+      for (int i = 0; i < n_points; ++i) z_in(i) = gw.mesh()[i];
 
-          for (int i = 0; i < n_points; ++i) z_in(i) = gw.mesh()[i];
-          for (int i = 0; i < n_points; ++i) u_in(i) = gw.on_mesh(i)(n1, n2);
+      int n_om = gr.mesh().size();
+      arrays::vector<dcomplex> e(n_om);
+      for (auto om : gr.mesh()) e(om.index()) = om + dcomplex(0.0, 1.0) * freq_offset;
 
-          triqs::utility::pade_approximant PA(z_in, u_in);
-
-          for (auto om : gr.mesh()) {
-            dcomplex e     = om + dcomplex(0.0, 1.0) * freq_offset;
-            gr[om](n1, n2) = PA(e);
+      // Elements with identical input values (e.g. degenerate diagonal elements) share
+      // a single continued fraction
+      std::map<std::vector<double>, int> input_to_task;
+      std::vector<arrays::vector<dcomplex>> tasks;
+      arrays::array<int, 2> task_of(N1, N2);
+      for (int n1 = 0; n1 < N1; n1++) {
+        for (int n2 = 0; n2 < N2; n2++) {
+          arrays::vector<dcomplex> u_in(n_points);
+          std::vector<double> key(2 * n_points);
+          for (int i = 0; i < n_points; ++i) {
+            u_in(i)        = gw.on_mesh(i)(n1, n2);
+            key[2 * i]     = u_in(i).real();
+            key[2 * i + 1] = u_in(i).imag();
           }
+          auto r = input_to_task.insert({std::move(key), int(tasks.size())});
+          if (r.second) tasks.push_back(std::move(u_in));
+          task_of(n1, n2) = r.first->second;
         }
       }
+
+      // The continued fractions are independent : construct and evaluate them in parallel
+      int n_tasks = tasks.size();
+      arrays::array<dcomplex, 2> res(n_tasks, n_om);
+      std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic)
+      for (int t = 0; t < n_tasks; ++t) {
+        try {
+          triqs::utility::pade_approximant PA(z_in, tasks[t], adaptive_precision);
+          for (int w = 0; w < n_om; ++w) res(t, w) = PA(e(w));
+        } catch (...) {
+#pragma omp critical(pade_error)
+          error = std::current_exception();
+        }
+      }
+      if (error) std::rethrow_exception(error);
+
+      for (int n1 = 0; n1 < N1; n1++)
+        for (int n2 = 0; n2 < N2; n2++) gr.data()(range(), n1, n2) = res(task_of(n1, n2), range());
     }
 
-    void pade(gf_view<refreq, scalar_valued> gr, gf_const_view<imfreq, scalar_valued> gw, int n_points, double freq_offset) {
-      pade(reinterpret_scalar_valued_gf_as_matrix_valued(gr), reinterpret_scalar_valued_gf_as_matrix_valued(gw), n_points, freq_offset);
+    void pade(gf_view<refreq, scalar_valued> gr, gf_const_view<imfreq, scalar_valued> gw, int n_points, double freq_offset,
+              bool adaptive_precision) {
+      pade(reinterpret_scalar_valued_gf_as_matrix_valued(gr), reinterpret_scalar_valued_gf_as_matrix_valued(gw), n_points, freq_offset,
+           adaptive_precision);
     }
 
   } // namespace gfs
@@ -23,7 +23,18 @@
 namespace triqs {
   namespace gfs {
 
-    void pade(gf_view<refreq> gr, gf_const_view<imfreq> gw, int n_points, double freq_offset);
-    void pade(gf_view<refreq, scalar_valued> gr, gf_const_view<imfreq, scalar_valued> gw, int n_points, double freq_offset);
+    /**
+     * Analytic continuation of gw onto the real axis using Pade approximants (one per element)
+     *
+     * @param gr Real-frequency Green function, filled by the function
+     * @param gw Matsubara Green function
+     * @param n_points Number of Matsubara frequencies used to build the approximants
+     * @param freq_offset Imaginary shift of the real frequencies at which the approximants are evaluated
+     * @param adaptive_precision Compute the continued fraction coefficients in long double arithmetic
+     *        and switch to GMP floats only when they lose precision (see pade_approximant)
+     */
+    void pade(gf_view<refreq> gr, gf_const_view<imfreq> gw, int n_points, double freq_offset, bool adaptive_precision = false);
+    void pade(gf_view<refreq, scalar_valued> gr, gf_const_view<imfreq, scalar_valued> gw, int n_points, double freq_offset,
+              bool adaptive_precision = false);
   } // namespace gfs
 } // namespace triqs
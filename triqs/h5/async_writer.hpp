@@ -0,0 +1,153 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./group.hpp"
+#include "../utility/view_tools.hpp"
+#include <H5Fpublic.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace triqs::h5 {
+
+  /**
+   * Writes objects into a group with h5_write, on a dedicated thread.
+   *
+   * write copies the object (or takes it if it is moved in) and returns at once : the computation goes on while the data
+   * are compressed and written. The writes are done in the order of the calls.
+   *
+   * As the hdf5 library is in general not thread safe, no other hdf5 call (on any file) may be done
+   * while writes are pending : call wait() before. The destructor waits for all the pending writes.
+   *
+   * An exception thrown by a write is rethrown by the next call to write, wait or flush. The writes after it are not done.
+   */
+  class async_writer {
+    group _g;
+    size_t _max_pending;
+    std::deque<std::function<void()>> _tasks;
+    bool _busy = false, _stop = false;
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::thread _thread;
+
+    public:
+    /**
+     * @param g The group in which the objects are written
+     * @param max_pending Maximal number of writes pending. write waits when it is reached, bounding the memory used by the copies.
+     */
+    explicit async_writer(group g, size_t max_pending = 4) : _g(std::move(g)), _max_pending(std::max<size_t>(max_pending, 1)) {
+      _thread = std::thread([this]() { _loop(); });
+    }
+
+    async_writer(async_writer const &) = delete;
+    async_writer &operator=(async_writer const &) = delete;
+
+    ~async_writer() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _cv.notify_all();
+      _thread.join();
+    }
+
+    /// The group in which the objects are written. Do not use it while writes are pending.
+    group const &get_group() const { return _g; }
+
+    /**
+     * Write a copy of x (of its regular type, e.g. a gf for a gf_view) into name, on the writer thread.
+     * If x is an rvalue, it is moved instead of copied.
+     */
+    template <typename T> void write(std::string name, T &&x) {
+      _push([this, name = std::move(name), x = make_regular(std::forward<T>(x))]() { h5_write(_g, name, x); });
+    }
+
+    /// Wait for all the pending writes to be done. Rethrows the exception of a write, if any.
+    void wait() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv.wait(lock, [this] { return (_tasks.empty() and !_busy) or _error; });
+      _rethrow();
+    }
+
+    /// Wait for all the pending writes, then flush the file to the disk
+    void flush() {
+      wait();
+      H5Fflush(_g, H5F_SCOPE_GLOBAL);
+    }
+
+    /// Number of writes not done yet
+    size_t n_pending() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _tasks.size() + (_busy ? 1 : 0);
+    }
+
+    private:
+    // Called with the lock
+    void _rethrow() {
+      if (_error) {
+        auto e = _error;
+        _error = nullptr;
+        _tasks.clear();
+        std::rethrow_exception(e);
+      }
+    }
+
+    void _push(std::function<void()> task) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _tasks.size() < _max_pending or _error; });
+        _rethrow();
+        _tasks.push_back(std::move(task));
+      }
+      _cv.notify_all();
+    }
+
+    void _loop() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (true) {
+        _cv.wait(lock, [this] { return !_tasks.empty() or _stop; });
+        if (_tasks.empty()) return; // stop, and nothing left to do
+        auto task = std::move(_tasks.front());
+        _tasks.pop_front();
+        _busy = true;
+        lock.unlock();
+        std::exception_ptr err;
+        try {
+          task();
+        } catch (...) { err = std::current_exception(); }
+        task = nullptr; // free the copy without the lock
+        lock.lock();
+        _busy = false;
+        if (err and !_error) {
+          _error = err;
+          _tasks.clear();
+        }
+        _cv.notify_all();
+      }
+    }
+  };
+
+} // namespace triqs::h5
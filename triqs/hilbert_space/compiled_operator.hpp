@@ -0,0 +1,154 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <triqs/arrays.hpp>
+#include <triqs/utility/exceptions.hpp>
+#include <triqs/utility/numeric_ops.hpp>
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+namespace triqs {
+  namespace hilbert_space {
+
+    /// Sparse matrix representation of an [[imperative_operator]] restricted to a pair of Hilbert (sub)spaces
+    /**
+  Obtained from `imperative_operator::compile()`. The matrix elements, including the fermionic signs
+  and the indices of the target basis states, are computed once and stored in a compressed sparse column
+  (CSC) layout: for every basis state of the initial space, the list of (target index, value) pairs it is connected to.
+
+  Applying the operator is then a plain sparse matrix-vector product, without any Fock state manipulation
+  or basis state lookup. A set of states stored as the columns of a matrix can be transformed at once (sparse matrix-matrix product).
+
+  The object models the operator concept used by [[space_partition]].
+  @warning The target Hilbert space must outlive the compiled operator.
+  @tparam HilbertType Hilbert space type, one of [[hilbert_space]] and [[sub_hilbert_space]]
+  @tparam ScalarType Type of the matrix elements, normally `double` or `std::complex<double>`
+  @include triqs/hilbert_space/compiled_operator.hpp
+ */
+    template <typename HilbertType, typename ScalarType = double> class compiled_operator {
+
+      HilbertType const *target_hs = nullptr;
+      int n_rows_                  = 0;
+      std::vector<int> col_ptr     = {0}; // size n_cols + 1
+      std::vector<int> row_index;
+      std::vector<ScalarType> values;
+
+      public:
+      /// Accessor to `ScalarType` template parameter
+      using scalar_t = ScalarType;
+      /// A matrix element (target index, initial index, value)
+      using element_t = std::tuple<int, int, ScalarType>;
+
+      /// Construct a zero operator
+      compiled_operator() = default;
+
+      /// Construct from a list of matrix elements
+      /**
+   Duplicate (target, initial) pairs are summed up, vanishing elements are dropped.
+
+   @param target Hilbert space the operator maps to
+   @param n_cols Dimension of the initial Hilbert space
+   @param elements Non-vanishing matrix elements, in any order
+  */
+      compiled_operator(HilbertType const &target, int n_cols, std::vector<element_t> elements) : target_hs(&target), n_rows_(target.size()) {
+        std::sort(elements.begin(), elements.end(),
+                  [](element_t const &x, element_t const &y) { return std::tie(std::get<1>(x), std::get<0>(x)) < std::tie(std::get<1>(y), std::get<0>(y)); });
+
+        col_ptr.assign(n_cols + 1, 0);
+        row_index.reserve(elements.size());
+        values.reserve(elements.size());
+
+        for (auto it = elements.begin(); it != elements.end();) {
+          int r = std::get<0>(*it), c = std::get<1>(*it);
+          if (r < 0 || r >= n_rows_ || c < 0 || c >= n_cols) TRIQS_RUNTIME_ERROR << "compiled_operator : matrix element (" << r << "," << c << ") out of range";
+          ScalarType v = 0;
+          for (; it != elements.end() && std::get<0>(*it) == r && std::get<1>(*it) == c; ++it) v += std::get<2>(*it);
+          using triqs::utility::is_zero;
+          if (is_zero(v)) continue;
+          row_index.push_back(r);
+          values.push_back(v);
+          ++col_ptr[c + 1];
+        }
+        for (int c = 0; c < n_cols; ++c) col_ptr[c + 1] += col_ptr[c];
+      }
+
+      /// Dimension of the target Hilbert space
+      int n_rows() const { return n_rows_; }
+
+      /// Dimension of the initial Hilbert space
+      int n_cols() const { return int(col_ptr.size()) - 1; }
+
+      /// Number of stored non-vanishing matrix elements
+      int n_nonzeros() const { return values.size(); }
+
+      /// Return a constant reference to the target Hilbert space
+      HilbertType const &get_target_hilbert() const { return *target_hs; }
+
+      /// Act on a state and return a new state
+      /**
+   The returned state belongs to the target Hilbert space.
+
+   @tparam StateType Type of the initial state
+   @param st Initial state; its Hilbert space must have dimension `n_cols()`
+  */
+      template <typename StateType> StateType operator()(StateType const &st) const {
+        if (target_hs == nullptr) return StateType{};
+        if (st.size() != n_cols()) TRIQS_RUNTIME_ERROR << "compiled_operator : state of dimension " << st.size() << " , expected " << n_cols();
+        StateType target_st(*target_hs);
+        foreach (st, [&](int j, typename StateType::value_type amplitude) {
+          using triqs::utility::is_zero;
+          if (is_zero(amplitude)) return;
+          for (int k = col_ptr[j]; k < col_ptr[j + 1]; ++k) target_st(row_index[k]) += values[k] * amplitude;
+        })
+          ;
+        return target_st;
+      }
+
+      /// Act on a set of states at once
+      /**
+   @param x Matrix of shape (n_cols(), n_states), each column being an initial state
+   @return Matrix of shape (n_rows(), n_states), each column being the corresponding final state
+  */
+      template <typename T> arrays::matrix<T> apply_batch(arrays::matrix_const_view<T> x) const {
+        if (first_dim(x) != n_cols()) TRIQS_RUNTIME_ERROR << "compiled_operator : batch of dimension " << first_dim(x) << " , expected " << n_cols();
+        long n_states = second_dim(x);
+        // C ordering : the inner loop runs over the contiguous batch index
+        arrays::matrix<T> y(n_rows_, n_states);
+        y() = T(0);
+        if (n_states == 0) return y;
+        auto x_str = x.indexmap().strides()[1];
+        for (int j = 0; j < n_cols(); ++j) {
+          T const *x_row = &x(j, 0);
+          for (int k = col_ptr[j]; k < col_ptr[j + 1]; ++k) {
+            T *y_row = &y(row_index[k], 0);
+            auto v   = values[k];
+            for (long b = 0; b < n_states; ++b) y_row[b] += v * x_row[b * x_str];
+          }
+        }
+        return y;
+      }
+
+      template <typename T> arrays::matrix<T> apply_batch(arrays::matrix<T> const &x) const { return apply_batch(arrays::matrix_const_view<T>{x}); }
+    };
+  } // namespace hilbert_space
+} // namespace triqs
@@ -22,6 +22,7 @@
 #include "./fundamental_operator_set.hpp"
 #include "../operators/many_body_operator.hpp"
 #include "./hilbert_space.hpp"
+#include "./compiled_operator.hpp"
 
 #include <vector>
 #include <utility>
@@ -157,6 +158,17 @@ namespace triqs {
         return v & 0x01;
       }
 
+      // Act with monomial M on the Fock state f2. Returns false if the result vanishes,
+      // otherwise sets the final Fock state f3 and the sign of the matrix element.
+      static bool apply_monomial(one_term_t const &M, fock_state_t f2, fock_state_t &f3, bool &sign_is_minus) {
+        if ((f2 & M.d_mask) != M.d_mask) return false;
+        f2 &= ~M.d_mask;
+        if (((f2 ^ M.dag_mask) & M.dag_mask) != M.dag_mask) return false;
+        f3            = ~(~f2 & ~M.dag_mask);
+        sign_is_minus = parity_number_of_bits((f2 & M.d_count_mask) ^ (f3 & M.dag_count_mask));
+        return true;
+      }
+
       // Forward the call to the coefficient
 #ifdef GCC_BUG_41933_WORKAROUND
       template <typename... Args>
@@ -205,12 +217,9 @@ namespace triqs {
 #else
           foreach (st, [M, &target_st, hs, args...](int i, typename StateType::value_type amplitude) {
 #endif
-            fock_state_t f2 = hs.get_fock_state(i);
-            if ((f2 & M.d_mask) != M.d_mask) return;
-            f2 &= ~M.d_mask;
-            if (((f2 ^ M.dag_mask) & M.dag_mask) != M.dag_mask) return;
-            fock_state_t f3    = ~(~f2 & ~M.dag_mask);
-            auto sign_is_minus = parity_number_of_bits((f2 & M.d_count_mask) ^ (f3 & M.dag_count_mask));
+            fock_state_t f3;
+            bool sign_is_minus;
+            if (!apply_monomial(M, hs.get_fock_state(i), f3, sign_is_minus)) return;
             // update state vector in target Hilbert space
             auto ind = target_st.get_hilbert().get_state_index(f3);
 #ifdef GCC_BUG_41933_WORKAROUND
@@ -223,6 +232,44 @@ namespace triqs {
         }
         return target_st;
       }
+
+      /// Compile the operator into a sparse matrix acting from one Hilbert (sub)space to another
+      /**
+   All matrix elements connecting basis states of `from` to basis states of `to` are computed once;
+   components of the result lying outside of `to` are discarded.
+   This is only possible for numeric coefficients (`ScalarType` is not a callable object).
+
+   @param from Initial Hilbert space
+   @param to Target Hilbert space; must outlive the returned object
+   @return [[compiled_operator]] object
+  */
+      template <typename HS1, typename HS2> compiled_operator<HS2, scalar_t> compile(HS1 const &from, HS2 const &to) const {
+        std::vector<typename compiled_operator<HS2, scalar_t>::element_t> elements;
+        for (int i = 0; i < from.size(); ++i) {
+          auto f2 = from.get_fock_state(i);
+          for (auto const &M : all_terms) {
+            fock_state_t f3;
+            bool sign_is_minus;
+            if (!apply_monomial(M, f2, f3, sign_is_minus) || !to.has_state(f3)) continue;
+            elements.emplace_back(to.get_state_index(f3), i, sign_is_minus ? -M.coeff : M.coeff);
+          }
+        }
+        return {to, from.size(), std::move(elements)};
+      }
+
+      /// Compile the operator into a sparse matrix acting on a given Hilbert subspace
+      /**
+   The target subspace is taken from the connection map (only for `UseMap = true`).
+
+   @param from Initial Hilbert subspace
+   @return [[compiled_operator]] object; it has no target space if `from` is mapped to nothing
+  */
+      compiled_operator<sub_hilbert_space, scalar_t> compile(sub_hilbert_space const &from) const {
+        static_assert(UseMap, "compile(from) requires a connection map");
+        auto n = hilbert_map[from.get_index()];
+        if (n == -1) return {};
+        return compile(from, (*sub_spaces)[n]);
+      }
     };
   } // namespace hilbert_space
 } // namespace triqs
@@ -103,6 +103,30 @@ namespace triqs {
     }
 
     //------------------------------------------------------------------------------------
+
+    std::vector<matrix<double>> point_group(bravais_lattice const &bl, double tolerance) {
+      int d      = bl.dim();
+      auto A     = matrix<double>(bl.units());
+      auto A_inv = matrix<double>(inverse(A));
+      std::vector<matrix<double>> res;
+      // M is identity outside of the d x d block (the completed unit vectors are orthonormal to the lattice)
+      matrix<double> M = arrays::make_unit_matrix<double>(3);
+      long n_candidates = std::pow(3, d * d);
+      for (long c = 0; c < n_candidates; ++c) {
+        for (long r = c, i = 0; i < d * d; ++i, r /= 3) M(i / d, i % d) = r % 3 - 1;
+        // O a_i = M_ij a_j, i.e. A O^T = M A
+        matrix<double> Ot = A_inv * M * A;
+        matrix<double> P  = Ot * Ot.transpose();
+        if (max_element(abs(P - arrays::make_unit_matrix<double>(3))) > tolerance) continue;
+        matrix<double> O = Ot.transpose();
+        if (max_element(abs(M - arrays::make_unit_matrix<double>(3))) == 0)
+          res.insert(res.begin(), O);
+        else
+          res.push_back(O);
+      }
+      return res;
+    }
+
     //------------------------------------------------------------------------------------
 
   } // namespace lattice
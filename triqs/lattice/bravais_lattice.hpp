@@ -93,5 +93,18 @@ namespace triqs {
       std::vector<std::string> atom_orb_name; // names of these atoms/orbitals.
       int dim_;
     };
+
+    /**
+     * The point group of the Bravais lattice : the orthogonal transformations O (in cartesian coordinates) mapping the lattice onto itself,
+     * i.e. such that O a_i = sum_j M_ij a_j with M an integer matrix. The positions of the atoms/orbitals are not considered.
+     *
+     * The M with coefficients in {-1, 0, 1} are tried, which is enough for the usual (cubic, square, hexagonal...) bases.
+     * The identity is the first element.
+     *
+     * @param bl The lattice
+     * @param tolerance Tolerance on the orthogonality of O
+     * @return The matrices O
+     */
+    std::vector<matrix<double>> point_group(bravais_lattice const &bl, double tolerance = 1.e-8);
   } // namespace lattice
 } // namespace triqs
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "./irreducible_bz_mesh.hpp"
+#include <triqs/arrays/linalg/det_and_inverse.hpp>
+#include <cmath>
+
+namespace triqs {
+  namespace gfs {
+
+    namespace {
+
+      bool is_integer(double x, double tolerance) { return std::abs(x - std::round(x)) <= tolerance; }
+
+      // The image of all the points of the mesh by O, as linear indices, or an empty vector if O does not map the mesh onto itself
+      std::vector<long> map_of_operation(gf_mesh<brillouin_zone> const &m, matrix<double> const &O, matrix<double> const &U_inv,
+                                         matrix<double> const &B_inv, double tolerance) {
+        auto d = m.get_dimensions();
+        std::vector<long> res(m.size());
+        for (long i = 0; i < d[0]; ++i)
+          for (long j = 0; j < d[1]; ++j)
+            for (long l = 0; l < d[2]; ++l) {
+              gf_mesh<brillouin_zone>::index_t n{i, j, l};
+              auto k                   = m.index_to_point(n);
+              arrays::vector<double> gk = O * k;
+              // coordinates of gk in the basis of the mesh units
+              gf_mesh<brillouin_zone>::index_t np;
+              for (int a = 0; a < 3; ++a) {
+                double x = 0;
+                for (int b = 0; b < 3; ++b) x += gk(b) * U_inv(b, a);
+                if (!is_integer(x, tolerance)) return {};
+                np[a] = std::lround(x);
+              }
+              np = m.index_modulo(np);
+              // the folded point must be equivalent to gk, i.e. differ by a reciprocal lattice vector
+              arrays::vector<double> dk = m.index_to_point(np) - gk;
+              for (int a = 0; a < 3; ++a) {
+                double x = 0;
+                for (int b = 0; b < 3; ++b) x += dk(b) * B_inv(b, a);
+                if (!is_integer(x, tolerance)) return {};
+              }
+              res[m.index_to_linear(n)] = m.index_to_linear(np);
+            }
+        return res;
+      }
+
+    } // namespace
+
+    irreducible_bz_mesh::irreducible_bz_mesh(gf_mesh<brillouin_zone> const &m, double tolerance) : _full(m) {
+      matrix<double> U_inv = inverse(m.units);
+      matrix<double> B_inv = inverse(matrix<double>(m.domain().units()));
+
+      // the operations of the point group which map the mesh onto itself
+      std::vector<std::vector<long>> maps;
+      for (auto const &O : lattice::point_group(m.domain().lattice())) {
+        auto mp = map_of_operation(m, O, U_inv, B_inv, tolerance);
+        if (mp.empty()) continue;
+        _ops.push_back(O);
+        maps.push_back(std::move(mp));
+      }
+
+      // the orbits, in the order of the full mesh
+      long N = m.size();
+      _irr_of_full.assign(N, -1);
+      _op_of_full.assign(N, 0);
+      for (long l = 0; l < N; ++l) {
+        if (_irr_of_full[l] >= 0) continue;
+        long irr    = _full_of_irr.size();
+        long n_orbit = 0;
+        for (long g = 0; g < long(maps.size()); ++g) {
+          long lp = maps[g][l];
+          if (_irr_of_full[lp] >= 0) continue;
+          _irr_of_full[lp] = irr;
+          _op_of_full[lp]  = g;
+          ++n_orbit;
+        }
+        _full_of_irr.push_back(l);
+        _weights.push_back(double(n_orbit) / N);
+      }
+    }
+
+  } // namespace gfs
+} // namespace triqs
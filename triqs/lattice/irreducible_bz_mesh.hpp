@@ -0,0 +1,168 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "./gf_mesh_brillouin_zone.hpp"
+
+namespace triqs {
+  namespace gfs {
+
+    // for the gf versions of reduce and unfold : include <triqs/gfs.hpp> to use them
+    struct matrix_valued;
+    template <typename Var, typename Target> class gf;
+
+    /**
+     * The irreducible wedge of a Brillouin zone mesh, for the point group of its Bravais lattice.
+     *
+     * The k-points of the full mesh are grouped in orbits under the operations of the point group which map the mesh onto itself.
+     * Each orbit is represented by one irreducible point (the first of the orbit in the full mesh), with the weight |orbit| / N_k.
+     *
+     * A function of k invariant under the group (e.g. a scalar, or a diagonal gf of equivalent orbitals) is stored by its values
+     * on the irreducible points : an array whose first dimension runs over them. It is unfolded to the full mesh only when needed,
+     * e.g. for a Fourier transform or an interpolation (unfold), or read at any full point without unfolding (full_to_irreducible).
+     * For a non invariant function, op_index gives the operation relating each point to its irreducible point.
+     */
+    class irreducible_bz_mesh {
+      gf_mesh<brillouin_zone> _full;
+      std::vector<matrix<double>> _ops; // the cartesian operations mapping the mesh onto itself, the identity first
+      std::vector<long> _irr_of_full;   // full linear index -> irreducible index
+      std::vector<long> _op_of_full;    // full linear index -> the operation g with k_full = g k_irr
+      std::vector<long> _full_of_irr;   // irreducible index -> full linear index of its representative
+      std::vector<double> _weights;     // irreducible index -> weight in the k-sums
+
+      public:
+      using index_t = gf_mesh<brillouin_zone>::index_t;
+
+      irreducible_bz_mesh() = default;
+
+      /**
+       * @param m The full mesh
+       * @param tolerance Tolerance on the coordinates of the transformed points
+       */
+      explicit irreducible_bz_mesh(gf_mesh<brillouin_zone> const &m, double tolerance = 1.e-8);
+
+      /// The full mesh
+      gf_mesh<brillouin_zone> const &full_mesh() const { return _full; }
+
+      /// Number of irreducible points
+      long size() const { return _full_of_irr.size(); }
+
+      /// The operations of the point group which map the mesh onto itself (cartesian, the identity first)
+      std::vector<matrix<double>> const &operations() const { return _ops; }
+
+      /// Weights of the irreducible points in the k-sums (they sum to 1)
+      std::vector<double> const &weights() const { return _weights; }
+
+      /// Irreducible index of a point of the full mesh
+      long full_to_irreducible(long full_linear_index) const { return _irr_of_full[full_linear_index]; }
+      long full_to_irreducible(index_t const &n) const { return _irr_of_full[_full.index_to_linear(_full.index_modulo(n))]; }
+
+      /// Linear index in the full mesh of the irreducible point
+      long irreducible_to_full(long irr) const { return _full_of_irr[irr]; }
+
+      /// Index of the operation g such that k_full = g k_irreducible
+      long op_index(long full_linear_index) const { return _op_of_full[full_linear_index]; }
+
+      /// Index (in the full mesh) of the irreducible point
+      index_t index(long irr) const {
+        auto d = _full.get_dimensions();
+        long l = _full_of_irr[irr];
+        return {l / (d[1] * d[2]), (l / d[2]) % d[1], l % d[2]};
+      }
+
+      /// The irreducible point, in cartesian coordinates
+      lattice::k_t k(long irr) const { return _full.index_to_point(index(irr)); }
+
+      // ------------------------- Data --------------------------
+
+      /// The values at the irreducible points of data on the full mesh (first dimension), or of a gf on the full mesh
+      template <typename A> auto reduce(A const &full_data) const {
+        if constexpr (not arrays::ImmutableCuboidArray<A>::value) {
+          if (full_data.mesh() != _full) TRIQS_RUNTIME_ERROR << "irreducible_bz_mesh : the gf is not on the full mesh of the irreducible wedge";
+          return reduce(full_data.data());
+        } else {
+          if (full_data.shape()[0] != _full.size()) TRIQS_RUNTIME_ERROR << "irreducible_bz_mesh : the data are not on the full mesh";
+          auto L = full_data.shape();
+          L[0]   = size();
+          arrays::array<typename A::value_type, A::rank> res(L);
+          for (long i = 0; i < size(); ++i) res(i, arrays::ellipsis()) = full_data(_full_of_irr[i], arrays::ellipsis());
+          return res;
+        }
+      }
+
+      /// The data on the full mesh from the values at the irreducible points (first dimension). The function must be invariant.
+      template <typename A> auto unfold(A const &irr_data) const REQUIRES(arrays::ImmutableCuboidArray<A>::value) {
+        if (irr_data.shape()[0] != size()) TRIQS_RUNTIME_ERROR << "irreducible_bz_mesh : the data are not on the irreducible points";
+        auto L = irr_data.shape();
+        L[0]   = _full.size();
+        arrays::array<typename A::value_type, A::rank> res(L);
+        for (long l = 0; l < long(_full.size()); ++l) res(l, arrays::ellipsis()) = irr_data(_irr_of_full[l], arrays::ellipsis());
+        return res;
+      }
+
+      /// The gf on the full mesh (for a Fourier transform, an interpolation...) from its values at the irreducible points
+      template <typename Target = matrix_valued, typename A> gf<brillouin_zone, Target> unfold_gf(A const &irr_data) const {
+        static_assert(A::rank == 1 + Target::rank, "irreducible_bz_mesh : the rank of the data does not match the target");
+        return {_full, unfold(irr_data), {}};
+      }
+
+      /// The average over the Brillouin zone, sum_k f(k) / N_k, from the values at the irreducible points
+      template <typename A> auto k_sum(A const &irr_data) const REQUIRES(arrays::ImmutableCuboidArray<A>::value) {
+        using T = typename A::value_type;
+        if (irr_data.shape()[0] != size()) TRIQS_RUNTIME_ERROR << "irreducible_bz_mesh : the data are not on the irreducible points";
+        if constexpr (A::rank == 1) {
+          T res = 0;
+          for (long i = 0; i < size(); ++i) res += _weights[i] * irr_data(i);
+          return res;
+        } else {
+          arrays::array<T, A::rank - 1> res = _weights[0] * irr_data(0, arrays::ellipsis());
+          for (long i = 1; i < size(); ++i) res += _weights[i] * irr_data(i, arrays::ellipsis());
+          return res;
+        }
+      }
+
+      // ------------------------- Comparison, print, HDF5 --------------------------
+
+      bool operator==(irreducible_bz_mesh const &m) const { return _full == m._full and _irr_of_full == m._irr_of_full and _op_of_full == m._op_of_full; }
+      bool operator!=(irreducible_bz_mesh const &m) const { return !(operator==(m)); }
+
+      friend std::ostream &operator<<(std::ostream &sout, irreducible_bz_mesh const &m) {
+        return sout << "Irreducible wedge of " << m.size() << " points, for " << m._ops.size() << " operations, of the " << m._full;
+      }
+
+      static std::string hdf5_scheme() { return "IrreducibleMeshBrillouinZone"; }
+
+      /// Only the full mesh is written : the wedge is computed again when read
+      friend void h5_write(h5::group fg, std::string const &subgroup_name, irreducible_bz_mesh const &m) {
+        h5::group gr = fg.create_group(subgroup_name);
+        gr.write_hdf5_scheme(m);
+        h5_write(gr, "full_mesh", m._full);
+      }
+
+      friend void h5_read(h5::group fg, std::string const &subgroup_name, irreducible_bz_mesh &m) {
+        h5::group gr = fg.open_group(subgroup_name);
+        gr.assert_hdf5_scheme(m);
+        m = irreducible_bz_mesh{h5::h5_read<gf_mesh<brillouin_zone>>(gr, "full_mesh")};
+      }
+
+    };
+
+  } // namespace gfs
+} // namespace triqs
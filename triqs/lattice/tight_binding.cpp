@@ -19,9 +19,9 @@
  *
  ******************************************************************************/
 #include "tight_binding.hpp"
+#include <triqs/gfs.hpp>
 #include <triqs/arrays/algorithms.hpp>
 #include <triqs/arrays/linalg/eigenelements.hpp>
-#include "grid_generator.hpp"
 namespace triqs {
   namespace lattice {
 
@@ -57,7 +57,11 @@ namespace triqs {
       int ndim = TB.lattice().dim();
       array<double, 2> eval(norb, n_pts);
       k_t dk = (K2 - K1) / double(n_pts), k = K1;
-      for (int i = 0; i < n_pts; ++i, k += dk) { eval(range(), i) = linalg::eigenvalues(TK(k(range(0, ndim)))()); }
+      linalg::eigenelements_worker<dcomplex> worker(linalg::eigensolver::syevd); // reuses its workspace along the path
+      for (int i = 0; i < n_pts; ++i, k += dk) {
+        matrix<dcomplex> h = TK(k(range(0, ndim)))();
+        eval(range(), i)   = worker.eigenvalues(h);
+      }
       return eval;
     }
 
@@ -72,15 +76,59 @@ namespace triqs {
       return eval;
     }
 
+    //------------------------------------------------------
+
+    // H(k + k_shift) on the k_mesh, with k_shift in units of the reciprocal vectors.
+    // The phase of the shift is applied to t(R) before R is folded onto the cyclic lattice,
+    // so that hoppings longer than the mesh are handled exactly.
+    static gfs::gf<brillouin_zone, gfs::matrix_valued> _energy_matrix_on_bz_mesh(tight_binding const &TB, gfs::gf_mesh<brillouin_zone> const &k_mesh,
+                                                                                 std::array<double, 3> const &k_shift) {
+      using namespace gfs;
+      int norb    = TB.n_bands();
+      auto r_mesh = gf_mesh<cyclic_lattice>{TB.lattice(), k_mesh.periodization_matrix};
+      auto t_r    = gf<cyclic_lattice, matrix_valued>{r_mesh, {norb, norb}};
+      t_r.data()  = 0;
+      foreach (TB, [&](std::vector<long> const &displ, matrix<dcomplex> const &m) {
+        cluster_mesh::index_t r{0, 0, 0};
+        double dot_prod = 0;
+        for (int i = 0; i < displ.size(); ++i) {
+          r[i] = displ[i];
+          dot_prod += k_shift[i] * displ[i];
+        }
+        t_r.data()(r_mesh.index_to_linear(r_mesh.index_modulo(r)), range(), range()) += m * exp(2_j * M_PI * dot_prod);
+      })
+        ;
+      return make_gf_from_fourier(t_r, k_mesh);
+    }
+
+    gfs::gf<brillouin_zone, gfs::matrix_valued> energy_matrix_on_bz_mesh(tight_binding const &TB, gfs::gf_mesh<brillouin_zone> const &k_mesh) {
+      return _energy_matrix_on_bz_mesh(TB, k_mesh, {0, 0, 0});
+    }
+
+    // H(k) on the points of grid_generator(ndim, n_pts), ordered as the grid : (grid index, norb, norb).
+    // The grid_generator points sit in the middle of the cells of the regular k-mesh, hence the half step shift.
+    static array<dcomplex, 3> _energy_matrix_on_grid(tight_binding const &TB, int n_pts) {
+      int norb    = TB.n_bands();
+      int ndim    = TB.lattice().dim();
+      auto k_mesh = gfs::gf_mesh<brillouin_zone>{brillouin_zone{TB.lattice()}, n_pts};
+      auto dims   = k_mesh.get_dimensions();
+      auto hk     = _energy_matrix_on_bz_mesh(TB, k_mesh, {0.5 / dims[0], 0.5 / dims[1], 0.5 / dims[2]});
+      array<dcomplex, 3> res(k_mesh.size(), norb, norb);
+      for (auto const &k : k_mesh) {
+        auto n = k.index(); // grid_generator runs over x fastest
+        res(n[0] + dims[0] * (n[1] + dims[1] * n[2]), range(), range()) = hk[k];
+      }
+      return res;
+    }
+
     //------------------------------------------------------
     array<double, 2> energies_on_bz_grid(tight_binding const &TB, int n_pts) {
 
-      auto TK  = fourier(TB);
       int norb = TB.lattice().n_orbitals();
-      int ndim = TB.lattice().dim();
-      grid_generator grid(ndim, n_pts);
-      array<double, 2> eval(norb, grid.size());
-      for (; grid; ++grid) { eval(range(), grid.index()) = linalg::eigenvalues(TK((*grid)(range(0, ndim)))()); }
+      auto hk  = _energy_matrix_on_grid(TB, n_pts);
+      array<double, 2> eval(norb, hk.shape(0));
+      auto ev = linalg::eigenvalues_batched(hk);
+      for (int i = 0; i < hk.shape(0); ++i) eval(range(), i) = ev(i, range());
       return eval;
     }
 
@@ -88,30 +136,26 @@ namespace triqs {
 
     std::pair<array<double, 1>, array<double, 2>> dos(tight_binding const &TB, int nkpts, int neps) {
 
-      // The fourier transform of TK
-      auto TK = fourier(TB);
+      // H(k) on the whole grid, from a single FFT
+      auto hk = _energy_matrix_on_grid(TB, nkpts);
 
       // loop on the BZ
-      int ndim = TB.lattice().dim();
       int norb = TB.lattice().n_orbitals();
-      grid_generator grid(ndim, nkpts);
-      array<double, 1> tempeval(norb);
-      array<dcomplex, 3> evec(norb, norb, grid.size());
-      array<double, 2> eval(norb, grid.size());
+      int nk   = hk.shape(0);
+      array<dcomplex, 3> evec(norb, norb, nk);
+      array<double, 2> eval(norb, nk);
       if (norb == 1)
-        for (; grid; ++grid) {
-          double ee                = real(TK((*grid)(range(0, ndim)))(0, 0));
-          eval(0, grid.index())    = ee;
-          evec(0, 0, grid.index()) = 1;
+        for (int i = 0; i < nk; ++i) {
+          eval(0, i)    = real(hk(i, 0, 0));
+          evec(0, 0, i) = 1;
         }
-      else
-        for (; grid; ++grid) {
-          // cerr<<" index = "<<grid.index()<<endl;
-          array_view<double, 1> eval_sl   = eval(range(), grid.index());
-          array_view<dcomplex, 2> evec_sl = evec(range(), range(), grid.index());
-          std::tie(eval_sl, evec_sl)      = linalg::eigenelements(TK((*grid)(range(0, ndim)))); //,  true);
-          // cerr<< " point "<< *grid <<  " value "<< eval_sl<< endl; //" "<< (*grid) (range(0,ndim)) << endl;
+      else {
+        auto [ev, vec] = linalg::eigenelements_batched(hk);
+        for (int i = 0; i < nk; ++i) {
+          eval(range(), i)          = ev(i, range());
+          evec(range(), range(), i) = vec(i, range(), range());
         }
+      }
 
       // define the epsilon mesh, etc.
       array<double, 1> epsilon(neps);
@@ -127,13 +171,13 @@ namespace triqs {
       array<double, 2> rho(neps, norb);
       rho() = 0;
       for (int l = 0; l < norb; l++) {
-        for (int j = 0; j < grid.size(); j++) {
+        for (int j = 0; j < nk; j++) {
           int a = int((eval(l, j) - epsmin) / deps);
           if (a == int(neps)) a = a - 1;
           for (int k = 0; k < norb; k++) { rho(a, k) += real(conj(evec(l, k, j)) * evec(l, k, j)); }
         }
       }
-      rho /= grid.size() * deps;
+      rho /= nk * deps;
       return std::make_pair(epsilon, rho);
     }
 
@@ -22,8 +22,15 @@
 #include "brillouin_zone.hpp"
 #include <triqs/utility/complex_ops.hpp>
 #include <triqs/h5.hpp>
+#include "gf_mesh_brillouin_zone.hpp"
 
 namespace triqs {
+  namespace gfs {
+    // the result of energy_matrix_on_bz_mesh : include <triqs/gfs.hpp> to use it
+    struct matrix_valued;
+    template <typename Var, typename Target> class gf;
+  } // namespace gfs
+
   namespace lattice {
 
     /**
@@ -125,5 +132,12 @@ namespace triqs {
     array<double, 2> energies_on_bz_path(tight_binding const &TB, k_t const &K1, k_t const &K2, int n_pts);
     array<dcomplex, 3> energy_matrix_on_bz_path(tight_binding const &TB, k_t const &K1, k_t const &K2, int n_pts);
     array<double, 2> energies_on_bz_grid(tight_binding const &TB, int n_pts);
+
+    /**
+   H(k) on every point of a Brillouin zone mesh.
+   The hoppings t(R) are folded onto the cyclic lattice adjoint to k_mesh and transformed with a single FFT,
+   which costs O(N_k log N_k) instead of the O(N_k N_R) of evaluating fourier(TB) point by point.
+   */
+    gfs::gf<brillouin_zone, gfs::matrix_valued> energy_matrix_on_bz_mesh(tight_binding const &TB, gfs::gf_mesh<brillouin_zone> const &k_mesh);
   } // namespace lattice
 } // namespace triqs
@@ -21,6 +21,7 @@
 #pragma once
 #include <triqs/utility/first_include.hpp>
 #include <triqs/h5.hpp>
+#include "./mc_reduction.hpp"
 #include <string>
 namespace triqs {
   namespace mc_tools {
@@ -44,6 +45,17 @@ namespace triqs {
     template <typename T>
     struct has_collect_result<T, decltype(std::declval<T>().collect_results(std::declval<mpi::communicator>()))> : std::true_type {};
 
+    // Two-phase collection of results : the measure registers its accumulators in a fused_reduction, then finalizes
+    template <typename T, typename = void> struct has_fused_collect : std::false_type {};
+    template <typename T>
+    struct has_fused_collect<T, std::void_t<decltype(std::declval<T &>().register_accumulators(std::declval<fused_reduction &>())),
+                                            decltype(std::declval<T &>().finalize_results(std::declval<mpi::communicator>()))>> : std::true_type {};
+
+    // Asynchronous measure : snapshot(sign) captures what the measure needs, and returns a callable which accumulates it later
+    template <typename MCSignType, typename T, typename = void> struct has_snapshot : std::false_type {};
+    template <typename MCSignType, typename T>
+    struct has_snapshot<MCSignType, T, std::void_t<decltype(std::function<void()>(std::declval<T &>().snapshot(MCSignType())))>> : std::true_type {};
+
     // ----------------- h5 detection -----------------------
     using h5_rw_lambda_t = std::function<void(h5::group, std::string const &)>;
 
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace triqs {
+  namespace mc_tools {
+
+    // Wait a little, in a loop waiting for another thread : first yield, then sleep not to burn the core
+    inline void backoff(int n_wait) {
+      if (n_wait < 100)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    /**
+     * A bounded lock-free queue, with a single producer thread and a single consumer thread.
+     *
+     * push waits while the queue is full : this is the back-pressure on the producer.
+     */
+    template <typename T> class spsc_queue {
+      std::vector<T> _slots;
+      alignas(64) std::atomic<size_t> _head{0}; // next element to pop, written by the consumer only
+      alignas(64) std::atomic<size_t> _tail{0}; // next free slot, written by the producer only
+
+      public:
+      explicit spsc_queue(size_t capacity) : _slots(capacity) {}
+
+      spsc_queue(spsc_queue const &) = delete;
+      spsc_queue &operator=(spsc_queue const &) = delete;
+
+      size_t capacity() const { return _slots.size(); }
+
+      /// Producer : wait until there is room, then push x
+      void push(T x) {
+        size_t t = _tail.load(std::memory_order_relaxed);
+        for (int n_wait = 0; t - _head.load(std::memory_order_acquire) == _slots.size(); ++n_wait) backoff(n_wait);
+        _slots[t % _slots.size()] = std::move(x);
+        _tail.store(t + 1, std::memory_order_release);
+      }
+
+      /// Consumer : pop into x if the queue is not empty
+      bool try_pop(T &x) {
+        size_t h = _head.load(std::memory_order_relaxed);
+        if (h == _tail.load(std::memory_order_acquire)) return false;
+        x = std::move(_slots[h % _slots.size()]);
+        _head.store(h + 1, std::memory_order_release);
+        return true;
+      }
+
+      bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+    };
+
+    /**
+     * Worker threads for the asynchronous accumulation of the measures.
+     *
+     * Each worker has its own queue of tasks. All the tasks of a given measure are sent to the same worker,
+     * hence are done one at a time, in the order in which they were pushed : the accumulation is the same as the serial one,
+     * only different measures run concurrently.
+     *
+     * An exception thrown by a task stops its worker, and is rethrown by the next push or by finish.
+     */
+    class measure_worker_pool {
+      using task_t = std::function<void()>;
+
+      struct worker {
+        spsc_queue<task_t> queue;
+        std::thread thread;
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+        explicit worker(size_t capacity) : queue(capacity) {}
+      };
+
+      std::vector<std::unique_ptr<worker>> _workers;
+      std::atomic<bool> _stop{false};
+
+      public:
+      /**
+       * Start the threads.
+       *
+       * @param n_threads Number of worker threads (>0)
+       * @param queue_capacity Maximal number of pending tasks per worker
+       */
+      measure_worker_pool(int n_threads, size_t queue_capacity) {
+        for (int i = 0; i < n_threads; ++i) _workers.push_back(std::make_unique<worker>(queue_capacity));
+        for (auto &w : _workers) w->thread = std::thread([this, p = w.get()]() { _loop(*p); });
+      }
+
+      measure_worker_pool(measure_worker_pool const &) = delete;
+      measure_worker_pool &operator=(measure_worker_pool const &) = delete;
+
+      ~measure_worker_pool() { _join(); }
+
+      int n_threads() const { return _workers.size(); }
+
+      /// Queue the task on worker i. Waits if its queue is full.
+      void push(int i, task_t task) {
+        auto &w = *_workers[i];
+        if (w.failed.load(std::memory_order_acquire)) std::rethrow_exception(w.error);
+        w.queue.push(std::move(task));
+      }
+
+      /// Wait for all the tasks to be done, and stop the threads.
+      void finish() {
+        _join();
+        for (auto &w : _workers)
+          if (w->error) std::rethrow_exception(w->error);
+      }
+
+      private:
+      void _join() {
+        _stop.store(true, std::memory_order_release);
+        for (auto &w : _workers)
+          if (w->thread.joinable()) w->thread.join();
+      }
+
+      void _loop(worker &w) {
+        task_t task;
+        int n_idle = 0;
+        while (true) {
+          if (w.queue.try_pop(task)) {
+            n_idle = 0;
+            if (w.failed.load(std::memory_order_relaxed)) continue; // drop the remaining tasks
+            try {
+              task();
+            } catch (...) {
+              w.error = std::current_exception();
+              w.failed.store(true, std::memory_order_release);
+            }
+          } else if (_stop.load(std::memory_order_acquire)) {
+            if (w.queue.empty()) return;
+          } else
+            backoff(n_idle < 100 ? n_idle++ : n_idle);
+        }
+      }
+    };
+
+  } // namespace mc_tools
+} // namespace triqs
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <mpi/mpi.hpp>
+#include <algorithm>
+#include <cstdint>
+
+namespace triqs::mc_tools {
+
+  /**
+   * Decides together with the other nodes when a run stops, from the total number of cycles done on all nodes.
+   *
+   * The nodes share their number of cycles done with a non-blocking all_reduce, started every interval seconds,
+   * and sooner when the end is predicted to be near. The run goes on while it is in flight.
+   * All nodes see the same results of the reductions in the same order, hence stop after the same one :
+   * when the total reaches the target, or when one of them asks to stop (stop_callback, signal).
+   */
+  class cooperative_stop {
+    mpi::communicator c;
+    double interval;
+    int64_t target;
+    MPI_Request request = MPI_REQUEST_NULL;
+    int64_t buf[3];            // cycles done, number of nodes stopped by stop_callback, by a signal
+    int64_t n_done_total = 0;  // total number of cycles done on all nodes, as of the last completed reduction
+    double request_time = 0;   // time at which the current request was started
+    double next_time    = 0;   // time at which the next request will be started
+
+    public:
+    /// Collective. The target is the sum of n_cycles over all nodes.
+    cooperative_stop(mpi::communicator c, uint64_t n_cycles, double interval) : c(c), interval(interval) {
+      target = mpi::all_reduce(int64_t(n_cycles), c);
+    }
+
+    cooperative_stop(cooperative_stop const &) = delete;
+    cooperative_stop &operator=(cooperative_stop const &) = delete;
+
+    ~cooperative_stop() {
+      if (request != MPI_REQUEST_NULL) MPI_Wait(&request, MPI_STATUS_IGNORE);
+    }
+
+    /// Is the total number of cycles to do 0 ?
+    bool nothing_to_do() const { return target == 0; }
+
+    /// The total number of cycles to do on all nodes
+    int64_t total_target() const { return target; }
+
+    /// The total number of cycles done on all nodes, as known from the last completed exchange
+    int64_t total_done() const { return n_done_total; }
+
+    /**
+     * Call after each cycle.
+     *
+     * @param n_done Number of cycles done on this node
+     * @param stop_requested Has stop_callback returned true on this node
+     * @param signal_received Has this node received a signal
+     * @param time Time since the beginning of the run
+     * @return -1 to continue, or the status of the run : 0 (target reached), 1 (stop_callback), 2 (signal)
+     */
+    int check(uint64_t n_done, bool stop_requested, bool signal_received, double time) {
+      if (request != MPI_REQUEST_NULL) {
+        int flag = 0;
+        MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
+        if (!flag) return -1;
+        n_done_total = buf[0];
+        if (buf[2] > 0) return 2;
+        if (buf[1] > 0) return 1;
+        if (buf[0] >= target) return 0;
+        // Start the next request when the target should be reached, estimated from the mean rate of all nodes.
+        double rate      = (request_time > 0 ? buf[0] / request_time : 0);
+        double remaining = (rate > 0 ? (target - buf[0]) / rate - (time - request_time) : interval);
+        next_time        = time + std::clamp(remaining, 0.0, interval);
+      }
+      if ((time >= next_time) or stop_requested or signal_received) {
+        buf[0]       = n_done;
+        buf[1]       = stop_requested;
+        buf[2]       = signal_received;
+        request_time = time;
+        MPI_Iallreduce(MPI_IN_PLACE, buf, 3, MPI_INT64_T, MPI_SUM, c.get(), &request);
+      }
+      return -1;
+    }
+  };
+
+} // namespace triqs::mc_tools
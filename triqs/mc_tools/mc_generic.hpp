@@ -25,11 +25,14 @@
 #include <triqs/utility/timestamp.hpp>
 #include <triqs/utility/report_stream.hpp>
 #include <triqs/utility/signal_handler.hpp>
+#include <triqs/utility/scope_guard.hpp>
 #include <mpi/mpi.hpp>
 #include "./mc_measure_aux_set.hpp"
 #include "./mc_measure_set.hpp"
 #include "./mc_move_set.hpp"
 #include "./random_generator.hpp"
+#include "./mc_cooperative_stop.hpp"
+#include <optional>
 
 namespace triqs::mc_tools {
 
@@ -126,6 +129,47 @@ namespace triqs::mc_tools {
    */
     void set_after_cycle_duty(std::function<void()> f) { after_cycle_duty = f; }
 
+    /**
+   * Stop the accumulations together on all the nodes of c.
+   *
+   * The number of cycles of accumulate is then the mean over the nodes : the accumulation stops on all nodes
+   * when the total number of cycles done reaches the sum of n_cycles over the nodes, or when stop_callback
+   * returns true (or a signal is received) on any of them. Fast nodes do more cycles than slow ones, and all finish at the same time.
+   * The nodes share their progress with non-blocking communications, without waiting for each other.
+   *
+   * The warmup is not affected : each node thermalizes its own Markov chain for its n_warmup_cycles.
+   *
+   * @param c              The communicator. All its nodes must call warmup/accumulate.
+   * @param check_interval Maximal time between two exchanges of the progress, in seconds.
+   */
+    void set_cooperative_stop(mpi::communicator c, double check_interval = 0.5) {
+      coop_comm     = c;
+      coop_interval = check_interval;
+    }
+
+    /// Each node stops its runs independently (default)
+    void unset_cooperative_stop() { coop_comm.reset(); }
+
+    /**
+   * Accumulate the asynchronous measures on worker threads.
+   *
+   * An asynchronous measure has, besides accumulate, a method snapshot(MCSignType const & sign) called after each cycle
+   * in place of accumulate, on the Monte Carlo thread. It copies what the measure needs (part of the configuration, results of
+   * the measure_aux, ...) and returns a callable (void()), which does the accumulation later on a worker thread, while the
+   * Markov chain goes on. It must not read the configuration, which has changed by then.
+   * Each measure is accumulated by a single worker, in the order of the cycles, and different measures concurrently :
+   * the results are the same as with the serial accumulation. The other measures are accumulated on the Monte Carlo thread.
+   * All the pending accumulations are done before accumulate returns.
+   *
+   * @param n_threads      Number of worker threads. 0 (default) : all the measures are accumulated on the Monte Carlo thread.
+   * @param queue_capacity Maximal number of pending snapshots per worker. When it is reached, the Markov chain waits for the worker.
+   */
+    void set_measure_threads(int n_threads, size_t queue_capacity = 64) {
+      if (queue_capacity == 0) TRIQS_RUNTIME_ERROR << "mc_generic : the capacity of the queue of the measures must be > 0";
+      n_measure_threads  = n_threads;
+      measure_queue_size = queue_capacity;
+    }
+
     int warmup(uint64_t n_warmup_cycles, int64_t length_cycle, std::function<bool()> stop_callback) {
       report << "\nWarming up ..." << std::endl;
       return run(n_warmup_cycles, length_cycle, stop_callback, false);
@@ -213,13 +257,18 @@ namespace triqs::mc_tools {
     int run(uint64_t n_cycles, uint64_t length_cycle, std::function<bool()> stop_callback, bool do_measure = true) {
       utility::timer timer;
       timer.start();
-      if (n_cycles == 0) return 0;
+      std::optional<cooperative_stop> coop;
+      if (coop_comm and do_measure) coop.emplace(*coop_comm, n_cycles, coop_interval); // the warmup is done on each node
+      if (coop ? coop->nothing_to_do() : n_cycles == 0) return 0;
       triqs::signal_handler::start();
       done_percent = 0;
       nmeasures    = 0;
-      bool stop_it = false, finished = false;
+      bool stop_it = false, finished = false, stop_requested = false;
+      int coop_status       = -1;
       int NC                = 0;
       double next_info_time = 0.1;
+      if (do_measure) AllMeasures.start_async(n_measure_threads, measure_queue_size);
+      auto _stop_async = utility::exec_at_scope_exit([this] { AllMeasures.stop_async(); }); // in case of exception
       for (; !stop_it; ++NC) { // do NOT reinit NC to 0
         // Metropolis loop. Switch here for HeatBath, etc...
         for (uint64_t k = 1; (k <= length_cycle); k++) {
@@ -243,17 +292,31 @@ namespace triqs::mc_tools {
         }
       // recompute fraction done
       _final:
-        done_percent = uint64_t(floor((NC * 100.0) / (n_cycles - 1)));
-        if (timer > next_info_time) {
-          report << utility::timestamp() << " " << std::setfill(' ') << std::setw(3) << done_percent << "%"
-                 << " ETA " << estimate_time_left(n_cycles, NC, timer) << " cycle " << NC << " of " << n_cycles << "\n"
-                 << std::flush;
-          next_info_time = 1.25 * timer + 2.0; // Increase time interval non-linearly
+        // in a cooperative run, the progress is the one of all the nodes
+        {
+          int64_t n_done = (coop ? coop->total_done() : NC), n_tot = (coop ? coop->total_target() : n_cycles);
+          int64_t n_last = std::max<int64_t>(n_tot - 1, 1);
+          done_percent   = uint64_t(floor((std::min(n_done, n_last) * 100.0) / n_last));
+          if (timer > next_info_time) {
+            report << utility::timestamp() << " " << std::setfill(' ') << std::setw(3) << done_percent << "%"
+                   << " ETA " << estimate_time_left(n_tot, std::min(n_done, n_last), timer) << " cycle " << n_done << " of " << n_tot
+                   << (coop ? " (all nodes)" : "") << "\n"
+                   << std::flush;
+            next_info_time = 1.25 * timer + 2.0; // Increase time interval non-linearly
+          }
+        }
+        if (coop) {
+          stop_requested = stop_requested || stop_callback();
+          coop_status    = coop->check(NC + 1, stop_requested, triqs::signal_handler::received(), double(timer));
+          finished       = (coop_status == 0);
+          stop_it        = (coop_status >= 0);
+        } else {
+          finished = NC + 1 >= n_cycles;
+          stop_it  = (stop_callback() || triqs::signal_handler::received() || finished);
         }
-        finished = NC + 1 >= n_cycles;
-        stop_it  = (stop_callback() || triqs::signal_handler::received() || finished);
       }
-      int status = (finished ? 0 : (triqs::signal_handler::received() ? 2 : 1));
+      AllMeasures.finish_async();
+      int status = (coop ? coop_status : (finished ? 0 : (triqs::signal_handler::received() ? 2 : 1)));
       triqs::signal_handler::stop();
       current_cycle_number += NC;
       timer.stop();
@@ -381,5 +444,9 @@ namespace triqs::mc_tools {
     MCSignType sign       = 1;
     uint64_t done_percent = 0;
     uint64_t config_id    = 0;
+    std::optional<mpi::communicator> coop_comm;
+    double coop_interval = 0.5;
+    int n_measure_threads     = 0;
+    size_t measure_queue_size = 64;
   };
 } // namespace triqs::mc_tools
@@ -23,10 +23,13 @@
 #include <mpi/mpi.hpp>
 #include <triqs/utility/exceptions.hpp>
 #include <triqs/utility/timer.hpp>
+#include <algorithm>
 #include <functional>
 #include <map>
+#include <memory>
 #include <cassert>
 #include "./impl_tools.hpp"
+#include "./mc_async_measures.hpp"
 
 namespace triqs {
   namespace mc_tools {
@@ -37,6 +40,9 @@ namespace triqs {
       std::shared_ptr<void> impl_;
       std::function<void(MCSignType const &)> accumulate_;
       std::function<void(mpi::communicator const &)> collect_results_;
+      std::function<void(fused_reduction &)> register_accumulators_; // empty if the measure does not use the two-phase protocol
+      std::function<void(mpi::communicator const &)> finalize_results_;
+      std::function<std::function<void()>(MCSignType const &)> snapshot_; // empty if the measure can not be accumulated asynchronously
       std::function<void(h5::group, std::string const &)> h5_r, h5_w;
 
       uint64_t count_;
@@ -47,13 +53,19 @@ namespace triqs {
       template <typename MeasureType> measure(bool, MeasureType &&m, bool enable_timer) : enable_timer(enable_timer) {
         static_assert(std::is_move_constructible<MeasureType>::value, "This measure is not MoveConstructible");
         static_assert(has_accumulate<MCSignType, MeasureType>::value, " This measure has no accumulate method !");
-        static_assert(has_collect_result<MeasureType>::value, " This measure has no collect_results method !");
+        static_assert(has_collect_result<MeasureType>::value or has_fused_collect<std::decay_t<MeasureType>>::value,
+                      " This measure has no collect_results method, nor register_accumulators and finalize_results !");
         using m_t        = std::decay_t<MeasureType>;
         m_t *p           = new m_t(std::forward<MeasureType>(m));
         impl_            = std::shared_ptr<m_t>(p);
         accumulate_      = [p](MCSignType const &x) { p->accumulate(x); };
         count_           = 0;
-        collect_results_ = [p](mpi::communicator const &c) { p->collect_results(c); };
+        if constexpr (has_fused_collect<m_t>::value) {
+          register_accumulators_ = [p](fused_reduction &r) { p->register_accumulators(r); };
+          finalize_results_      = [p](mpi::communicator const &c) { p->finalize_results(c); };
+        } else
+          collect_results_ = [p](mpi::communicator const &c) { p->collect_results(c); };
+        if constexpr (has_snapshot<MCSignType, m_t>::value) snapshot_ = [p](MCSignType const &x) -> std::function<void()> { return p->snapshot(x); };
         h5_r             = make_h5_read(p);
         h5_w             = make_h5_write(p);
       }
@@ -71,12 +83,48 @@ namespace triqs {
         accumulate_(signe);
         if(enable_timer) Timer.stop();
       }
+
+      /// Can the measure be accumulated on another thread (snapshot) ?
+      bool is_async() const { return bool(snapshot_); }
+
+      /// Take the snapshot of the measure now, and return the task accumulating it (to be run on a worker thread)
+      std::function<void()> make_accumulate_task(MCSignType const &signe) {
+        assert(impl_);
+        count_++;
+        return [this, f = snapshot_(signe)]() {
+          if (enable_timer) Timer.start();
+          f();
+          if (enable_timer) Timer.stop();
+        };
+      }
+
       void collect_results(mpi::communicator const &c) {
+        if (is_fused()) {
+          fused_reduction r;
+          register_accumulators(r);
+          r.all_reduce(c);
+          finalize_results(c);
+          return;
+        }
         if(enable_timer) Timer.start();
         collect_results_(c);
         if(enable_timer) Timer.stop();
       }
 
+      /// Does the measure collect its results in two phases (register_accumulators, then finalize_results) ?
+      bool is_fused() const { return bool(register_accumulators_); }
+
+      void register_accumulators(fused_reduction &r) {
+        if(enable_timer) Timer.start();
+        register_accumulators_(r);
+        if(enable_timer) Timer.stop();
+      }
+      void finalize_results(mpi::communicator const &c) {
+        if(enable_timer) Timer.start();
+        finalize_results_(c);
+        if(enable_timer) Timer.stop();
+      }
+
       uint64_t count() const { return count_; }
       double duration() const { return double(Timer); }
 
@@ -95,6 +143,7 @@ namespace triqs {
       using measure_type = measure<MCSignType>;
       using m_map_t      = std::map<std::string, measure<MCSignType>>;
       m_map_t m_map;
+      std::unique_ptr<measure_worker_pool> pool; // if not null, the asynchronous measures are accumulated by its threads
 
       public:
       using measure_ptr_t = typename m_map_t::const_iterator;
@@ -126,9 +175,37 @@ namespace triqs {
 
       ///
       void accumulate(MCSignType const &signe) {
-        for (auto &nmp : m_map) nmp.second.accumulate(signe);
+        int k = 0; // the k-th asynchronous measure always goes to the same worker
+        for (auto &nmp : m_map) {
+          if (pool and nmp.second.is_async())
+            pool->push(k++ % pool->n_threads(), nmp.second.make_accumulate_task(signe));
+          else
+            nmp.second.accumulate(signe);
+        }
+      }
+
+      /**
+       * From now on, accumulate the measures with a snapshot method on n_threads worker threads.
+       *
+       * The snapshot is taken in accumulate, the accumulation itself is done later by a worker, concurrently with the other measures.
+       * A given measure is always accumulated by the same worker, in order : its results are the same as in the serial case.
+       * Nothing is done if there is no such measure or if n_threads <= 0.
+       */
+      void start_async(int n_threads, size_t queue_capacity) {
+        bool has_async = std::any_of(m_map.begin(), m_map.end(), [](auto const &nmp) { return nmp.second.is_async(); });
+        if (n_threads > 0 and has_async) pool = std::make_unique<measure_worker_pool>(n_threads, queue_capacity);
+      }
+
+      /// Wait for all the pending accumulations, stop the workers. Rethrows the first exception of a measure, if any.
+      void finish_async() {
+        if (!pool) return;
+        auto p = std::move(pool);
+        p->finish();
       }
 
+      /// Wait for all the pending accumulations and stop the workers, ignoring the exceptions of the measures
+      void stop_async() { pool.reset(); }
+
       std::vector<std::string> names() const {
         std::vector<std::string> res;
         for (auto &nmp : m_map) res.push_back(nmp.first);
@@ -155,8 +232,18 @@ namespace triqs {
       }
 
       // gather result for all measure, on communicator c
+      // The accumulators of the measures using the two-phase protocol are all reduced together, before their finalize_results.
       void collect_results(mpi::communicator const &c) {
-        for (auto &nmp : m_map) nmp.second.collect_results(c);
+        fused_reduction r;
+        for (auto &nmp : m_map) {
+          if (nmp.second.is_fused())
+            nmp.second.register_accumulators(r);
+          else
+            nmp.second.collect_results(c);
+        }
+        r.all_reduce(c);
+        for (auto &nmp : m_map)
+          if (nmp.second.is_fused()) nmp.second.finalize_results(c);
       }
 
       // HDF5 interface
@@ -47,6 +47,7 @@ namespace triqs {
       std::function<void(h5::group, std::string const &)> h5_r, h5_w;
 
       uint64_t NProposed, Naccepted;
+      uint64_t NProposed_tot, Naccepted_tot; // sums over the nodes, during the collection of statistics
       double acceptance_rate_;
       bool is_move_set_; // need to remember if the move was a move_set for printing details later.
 
@@ -74,6 +75,8 @@ namespace triqs {
         h5_w                = make_h5_write(p);
         NProposed           = 0;
         Naccepted           = 0;
+        NProposed_tot       = 0;
+        Naccepted_tot       = 0;
         acceptance_rate_    = -1;
         is_move_set_        = std::is_same<MoveType, move_set<MCSignType>>::value;
       }
@@ -99,9 +102,21 @@ namespace triqs {
       uint64_t n_accepted_config() const { return Naccepted; }
 
       void collect_statistics(mpi::communicator const &c) {
-        uint64_t nacc_tot  = mpi::all_reduce(Naccepted, c);
-        uint64_t nprop_tot = mpi::all_reduce(NProposed, c);
-        acceptance_rate_   = nacc_tot / static_cast<double>(nprop_tot);
+        fused_reduction r;
+        register_statistics(r);
+        r.all_reduce(c);
+        finalize_statistics(c);
+      }
+
+      // Two phases of collect_statistics, to reduce the counters of all moves together
+      void register_statistics(fused_reduction &r) {
+        Naccepted_tot = Naccepted;
+        NProposed_tot = NProposed;
+        r.add(Naccepted_tot);
+        r.add(NProposed_tot);
+      }
+      void finalize_statistics(mpi::communicator const &c) {
+        acceptance_rate_ = Naccepted_tot / static_cast<double>(NProposed_tot);
         if (collect_statistics_) collect_statistics_(c);
       }
 
@@ -239,7 +254,10 @@ namespace triqs {
 
       ///
       void collect_statistics(mpi::communicator c) {
-        for (auto &m : move_vec) m.collect_statistics(c);
+        fused_reduction r;
+        for (auto &m : move_vec) m.register_statistics(r);
+        r.all_reduce(c);
+        for (auto &m : move_vec) m.finalize_statistics(c);
       }
 
       /// Acceptance rate of all moves as a map name:string -> acceptance_rate:double
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include <mpi/vector.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace triqs {
+  namespace mc_tools {
+
+    /**
+     * Sum over the nodes of many accumulators, with one collective for all floating point numbers and one for all integers.
+     *
+     * The accumulators are registered by reference with add, then all_reduce replaces each of them by its sum over the nodes.
+     * They must stay alive (and their data must not be reallocated) between add and all_reduce.
+     * As for any collective, all the nodes must register the same accumulators, with the same sizes, in the same order.
+     */
+    class fused_reduction {
+      std::vector<std::pair<double *, long>> _chunks; // the floating point payload, in doubles (a complex is 2 doubles)
+      std::vector<std::pair<void *, int>> _integers;  // address and size in bytes of the integer accumulators
+
+      public:
+      /// Register x : a double, std::complex<double>, an integer (not a bool or a character), or any object with mpi_foreach_payload (arrays, gf, ...)
+      template <typename T> void add(T &x) {
+        if constexpr (std::is_integral_v<T>) {
+          static_assert(sizeof(T) <= sizeof(int64_t), "fused_reduction : integer too large");
+          // a sum of bool or characters written back into them is meaningless (and undefined for a bool)
+          static_assert(!std::is_same_v<T, bool>, "fused_reduction : a bool can not be summed, use an integer");
+          static_assert(!std::is_same_v<T, char> and !std::is_same_v<T, wchar_t> and !std::is_same_v<T, char16_t> and !std::is_same_v<T, char32_t>,
+                        "fused_reduction : a character can not be summed, use an integer");
+          _integers.emplace_back(&x, int(sizeof(T)));
+        } else if constexpr (mpi::is_packable_scalar<T>)
+          _chunks.emplace_back(reinterpret_cast<double *>(&x), mpi::detail::n_doubles<T>);
+        else {
+          static_assert(mpi::has_mpi_payload<T>, "fused_reduction : this type can not be registered");
+          using mpi::mpi_foreach_payload; // std::vector is not found by ADL, the gf and arrays are
+          mpi_foreach_payload(x, [this](auto *p, long n) {
+            using U = std::remove_pointer_t<decltype(p)>;
+            static_assert(!std::is_const_v<U>, "fused_reduction : the accumulator must be mutable");
+            _chunks.emplace_back(reinterpret_cast<double *>(p), n * mpi::detail::n_doubles<U>);
+          });
+        }
+      }
+
+      /// Number of registered accumulators (integers and chunks of floating point numbers)
+      long size() const { return _chunks.size() + _integers.size(); }
+
+      /// Sum all the registered accumulators over the nodes of c. They all get the result.
+      void all_reduce(mpi::communicator c) {
+        if (!_chunks.empty()) mpi::detail::reduce_in_place_packed(*this, c, 0, true, MPI_SUM);
+
+        if (!_integers.empty()) {
+          std::vector<int64_t> buf;
+          buf.reserve(_integers.size());
+          for (auto [p, s] : _integers) buf.push_back(_get_int(p, s));
+          MPI_Allreduce(MPI_IN_PLACE, buf.data(), buf.size(), MPI_INT64_T, MPI_SUM, c.get());
+          for (long i = 0; i < long(buf.size()); ++i) _set_int(_integers[i].first, _integers[i].second, buf[i]);
+        }
+        _chunks.clear();
+        _integers.clear();
+      }
+
+      // For the packed reduction of mpi
+      template <typename F> friend void mpi_foreach_payload(fused_reduction &r, F const &f) {
+        for (auto [p, n] : r._chunks) f(p, n);
+      }
+
+      private:
+      // NB : the integers are summed as int64_t, hence also the unsigned ones (the sum is the same modulo 2^64).
+      static int64_t _get_int(void *p, int s) {
+        switch (s) {
+          case 1: return *static_cast<int8_t *>(p);
+          case 2: return *static_cast<int16_t *>(p);
+          case 4: return *static_cast<int32_t *>(p);
+          default: return *static_cast<int64_t *>(p);
+        }
+      }
+      static void _set_int(void *p, int s, int64_t x) {
+        switch (s) {
+          case 1: *static_cast<int8_t *>(p) = x; break;
+          case 2: *static_cast<int16_t *>(p) = x; break;
+          case 4: *static_cast<int32_t *>(p) = x; break;
+          default: *static_cast<int64_t *>(p) = x;
+        }
+      }
+    };
+
+  } // namespace mc_tools
+} // namespace triqs
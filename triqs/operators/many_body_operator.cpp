@@ -21,6 +21,7 @@
 #include "./many_body_operator.hpp"
 #include <triqs/h5.hpp>
 #include <triqs/h5/base.hpp>
+#include <mutex>
 
 namespace triqs {
   namespace operators {
@@ -31,6 +32,64 @@ namespace triqs {
 // maximum order of the monomial (here quartic operators)
 #define MAX_MONOMIAL_SIZE 4
 
+    /// ----- interning of the indices
+
+    namespace detail {
+
+      namespace {
+        // The keys are spread over [1, 2^63) : consecutive insertions at the ends of the table are spaced by 2^32,
+        // an insertion between two sequences takes the middle of their keys. When there is no room left, the sequence
+        // gets no key and is compared lexicographically.
+        constexpr std::uint64_t key_min = 1, key_max = std::uint64_t(1) << 63, key_step = std::uint64_t(1) << 32;
+
+        struct interning_table {
+          std::mutex mutex;
+          std::map<indices_t, interned_indices_t> map; // nodes are never erased, so their addresses are stable
+          int n_interned = 0;
+        };
+
+        // function-local static : canonical operators may be built during static initialization
+        interning_table &get_interning_table() {
+          static interning_table t;
+          return t;
+        }
+
+        std::uint64_t key_between(std::uint64_t lower, std::uint64_t upper) { return (upper - lower >= 2 ? lower + (upper - lower) / 2 : 0); }
+
+        // Key for a new sequence, given the closest sequences with a key below and above it (0 if none)
+        std::uint64_t make_key(std::uint64_t lower, std::uint64_t upper) {
+          if (!lower && !upper) return key_max / 2;
+          if (!upper) return (key_max - lower > key_step ? lower + key_step : key_between(lower, key_max));
+          if (!lower) return (upper - key_min > key_step ? upper - key_step : key_between(key_min - 1, upper));
+          return key_between(lower, upper);
+        }
+      } // namespace
+
+      std::mutex &sorting_mutex() {
+        static std::mutex m;
+        return m;
+      }
+
+      interned_indices_t intern_indices(indices_t const &indices) {
+        auto &table = get_interning_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        auto it = table.map.lower_bound(indices);
+        if (it != table.map.end() && it->first == indices) return it->second;
+
+        // closest sequences with a key on both sides
+        std::uint64_t lower = 0, upper = 0;
+        for (auto it_up = it; it_up != table.map.end() && !upper; ++it_up) upper = it_up->second.key;
+        for (auto it_low = std::make_reverse_iterator(it); it_low != table.map.rend() && !lower; ++it_low) lower = it_low->second.key;
+
+        it         = table.map.emplace_hint(it, indices, interned_indices_t{});
+        it->second = {table.n_interned++, make_key(lower, upper), &it->first};
+        return it->second;
+      }
+    } // namespace detail
+
+    /// ----- printing
+
     struct print_visitor { // TODO C17 use generic lambda + if constexpr
       std::ostream &os;
       void operator()(std::string const &x) { os << '\'' << x << '\''; }
@@ -94,12 +153,12 @@ namespace triqs {
       // Its abs is the unique int associated to the series of indices of the C, from the fundamental_operator_set
       std::vector<h5_monomial> datavec;
 
-      for (auto const &m : op.monomials) { // for all monomials of the operator
-        if (m.first.size() > MAX_MONOMIAL_SIZE)
+      for (auto const &m : op) { // for all monomials of the operator, in order
+        if (m.monomial.size() > MAX_MONOMIAL_SIZE)
           TRIQS_RUNTIME_ERROR << " h5 writing many_body_operator : unexpected monomial with more than " << MAX_MONOMIAL_SIZE << "operators !";
-        h5_monomial y = {m.second.is_real(), real(m.second), imag(m.second), {0, 0, 0, 0}}; // we want to transform it to an h5_monomial
+        h5_monomial y = {m.coef.is_real(), real(m.coef), imag(m.coef), {0, 0, 0, 0}}; // we want to transform it to an h5_monomial
         int i         = 0;
-        for (auto const &c_cdag_op : m.first) {            // loop over the C C^+ operators of the monomial
+        for (auto const &c_cdag_op : m.monomial) {           // loop over the C C^+ operators of the monomial
           long c_number     = fops[c_cdag_op.indices] + 1; // the number of the C C^+ op. 0 means "no operators" here, so we shift by 1
           y.op_indices[i++] = (c_cdag_op.dagger ? c_number : -c_number);
         }
@@ -172,6 +231,7 @@ namespace triqs {
         real_or_complex s = (mon.is_real ? real_or_complex(mon.re) : real_or_complex(std::complex<double>(mon.re, mon.im)));
         op.monomials.insert({monomial, s}); // add the monomial to the operator
       }
+      op._monomials_changed();
     }
   } // namespace operators
 } // namespace triqs
@@ -23,8 +23,13 @@
 
 #include <ostream>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <boost/operators.hpp>
+#include <boost/container/small_vector.hpp>
 #include <triqs/utility/real_or_complex.hpp>
 #include <triqs/utility/numeric_ops.hpp>
 #include <triqs/h5.hpp>
@@ -47,25 +52,71 @@ namespace triqs {
 
     //-----------------------------------------------------------------------------------------
 
+    namespace detail {
+
+      /// A sequence of indices interned in a process-wide table
+      struct interned_indices_t {
+        /// Unique number of the sequence among all interned sequences
+        int id = -1;
+        /// Key preserving the lexicographic order of the sequences, 0 if none could be assigned
+        std::uint64_t key = 0;
+        /// The interned sequence. The table is never shrunk, so the pointer stays valid.
+        indices_t const *ptr = nullptr;
+      };
+
+      /// Protects the sorting of the terms of the (const) operators on their first iteration
+      std::mutex &sorting_mutex();
+
+      /// Intern a sequence of indices (thread-safe)
+      interned_indices_t intern_indices(indices_t const &indices);
+
+      /// The interned empty sequence, for the default constructed operators (interned once)
+      inline interned_indices_t const &empty_interned_indices() {
+        static const interned_indices_t r = intern_indices({});
+        return r;
+      }
+
+      // Lexicographic order of two interned sequences
+      inline bool less(interned_indices_t const &a, interned_indices_t const &b) {
+        if (a.id == b.id) return false;
+        if (a.key && b.key) return a.key < b.key;
+        return std::lexicographical_compare(a.ptr->begin(), a.ptr->end(), b.ptr->begin(), b.ptr->end());
+      }
+    } // namespace detail
+
     /// The canonical operator: a dagger and some indices
+    /**
+     * The indices are interned at construction, so that comparing, ordering and hashing
+     * canonical operators only involves a few integers. The indices are const, so that they can not
+     * get out of sync with their interned form.
+     *
+     * Trade-off : the construction locks a process-wide mutex and looks the indices up in a std::map,
+     * and the table is never freed (it holds each distinct sequence of indices once, for the life of the process).
+     */
     struct canonical_ops_t {
-      bool dagger;
-      indices_t indices;
+      bool dagger = false;
+      indices_t const indices;
+
+      canonical_ops_t() : _interned(detail::empty_interned_indices()) {}
+      canonical_ops_t(bool dagger_, indices_t indices_) : dagger(dagger_), indices(std::move(indices_)), _interned(detail::intern_indices(indices)) {}
+
       // Order: dagger < non dagger, and then indices
       // Example: c+_1 < c+_2 < c+_3 < c_3 < c_2 < c_1
       friend bool operator<(canonical_ops_t const &a, canonical_ops_t const &b) {
         if (a.dagger != b.dagger) return (a.dagger > b.dagger);
         if (a.dagger) // a.indices < b.indices
-          return std::lexicographical_compare(a.indices.begin(), a.indices.end(), b.indices.begin(), b.indices.end());
+          return detail::less(a._interned, b._interned);
         else // b.indices < a.indices
-          return std::lexicographical_compare(b.indices.begin(), b.indices.end(), a.indices.begin(), a.indices.end());
+          return detail::less(b._interned, a._interned);
       }
       friend bool operator>(canonical_ops_t const &a, canonical_ops_t const &b) { return b < a; }
-      friend bool operator==(canonical_ops_t const &a, canonical_ops_t const &b) {
-        return (a.dagger == b.dagger && a.indices.size() == b.indices.size() && std::equal(a.indices.begin(), a.indices.end(), b.indices.begin()));
-      }
+      friend bool operator==(canonical_ops_t const &a, canonical_ops_t const &b) { return (a.dagger == b.dagger && a._interned.id == b._interned.id); }
 
-      template <class Archive> void serialize(Archive &ar, const unsigned int version) { ar &dagger &indices; }
+      /// Unique number of the indices among all interned sequences (for hashing)
+      int indices_id() const { return _interned.id; }
+
+      private:
+      detail::interned_indices_t _interned;
     };
 
     std::ostream &operator<<(std::ostream &os, canonical_ops_t const &op);
@@ -91,11 +142,63 @@ namespace triqs {
        boost::multipliable<many_body_operator_generic<ScalarType>, ScalarType>, // op*a a*op op/a
        boost::dividable<many_body_operator_generic<ScalarType>, ScalarType> {
 
-      // Map of all monomials with coefficients
-      using monomials_map_t = std::map<monomial_t, ScalarType>;
+      struct monomial_hash {
+        std::size_t operator()(monomial_t const &m) const {
+          std::size_t h = m.size();
+          for (auto const &op : m) h = h * 1000003 ^ std::size_t(2 * op.indices_id() + op.dagger);
+          return h;
+        }
+      };
+
+      // Hash map of all monomials with coefficients
+      using monomials_map_t = std::unordered_map<monomial_t, ScalarType, monomial_hash>;
 
       monomials_map_t monomials;
 
+      // The terms in the order of the monomials, for the iteration (printing, h5, python).
+      // Sorted on demand after a modification : the terms are accumulated without ordering them.
+      using sorted_terms_t = std::vector<typename monomials_map_t::value_type const *>;
+      mutable sorted_terms_t _sorted_terms;
+      mutable std::atomic<bool> _is_sorted{false};
+
+      // To be called after the insertion or removal of monomials (not needed if only the coefficients change)
+      void _monomials_changed() { _is_sorted.store(false, std::memory_order_relaxed); }
+
+      // Sort the terms if needed. Several threads may iterate on the same (const) operator.
+      sorted_terms_t const &sorted_terms() const {
+        if (!_is_sorted.load(std::memory_order_acquire)) {
+          std::lock_guard<std::mutex> lock(detail::sorting_mutex());
+          if (!_is_sorted.load(std::memory_order_relaxed)) {
+            _sorted_terms.clear();
+            _sorted_terms.reserve(monomials.size());
+            for (auto const &m : monomials) _sorted_terms.push_back(&m);
+            std::sort(_sorted_terms.begin(), _sorted_terms.end(), [](auto const *x, auto const *y) { return x->first < y->first; });
+            _is_sorted.store(true, std::memory_order_release);
+          }
+        }
+        return _sorted_terms;
+      }
+
+      // A monomial as a sequence of pointers to canonical operators living in other monomials.
+      // Used as a scratch representation while multiplying and normalizing, to avoid copying the indices.
+      using packed_monomial_t = boost::container::small_vector<canonical_ops_t const *, 8>;
+
+      struct packed_monomial_hash {
+        std::size_t operator()(packed_monomial_t const &m) const {
+          std::size_t h = m.size();
+          for (auto const *op : m) h = h * 1000003 ^ std::size_t(2 * op->indices_id() + op->dagger);
+          return h;
+        }
+      };
+      struct packed_monomial_equal {
+        bool operator()(packed_monomial_t const &m1, packed_monomial_t const &m2) const {
+          return std::equal(m1.begin(), m1.end(), m2.begin(), m2.end(), [](auto const *x, auto const *y) { return *x == *y; });
+        }
+      };
+
+      // Hash-based store of the terms, where products are accumulated
+      using packed_map_t = std::unordered_map<packed_monomial_t, ScalarType, packed_monomial_hash, packed_monomial_equal>;
+
       friend void h5_write(h5::group g, std::string const &name, many_body_operator const &op, hilbert_space::fundamental_operator_set const &fops);
       friend void h5_write(h5::group g, std::string const &name, many_body_operator_generic const &op) {
         h5_write(g, name, op, op.make_fundamental_operator_set());
@@ -114,11 +217,21 @@ namespace triqs {
 
       static std::string hdf5_scheme() { return "Operator"; }
 
-      many_body_operator_generic()                                   = default;
-      many_body_operator_generic(many_body_operator_generic const &) = default;
-      many_body_operator_generic(many_body_operator_generic &&)      = default;
-      many_body_operator_generic &operator=(many_body_operator_generic const &) = default;
-      many_body_operator_generic &operator=(many_body_operator_generic &&) = default;
+      // The sorted terms are not copied : they point into the monomials of x
+      many_body_operator_generic() = default;
+      many_body_operator_generic(many_body_operator_generic const &x) : monomials(x.monomials) {}
+      many_body_operator_generic(many_body_operator_generic &&x) noexcept : monomials(std::move(x.monomials)) { x._monomials_changed(); }
+      many_body_operator_generic &operator=(many_body_operator_generic const &x) {
+        monomials = x.monomials;
+        _monomials_changed();
+        return *this;
+      }
+      many_body_operator_generic &operator=(many_body_operator_generic &&x) noexcept {
+        monomials = std::move(x.monomials);
+        _monomials_changed();
+        x._monomials_changed();
+        return *this;
+      }
 
       template <typename S> many_body_operator_generic(many_body_operator_generic<S> const &x) {
         static_assert(std::is_constructible<scalar_t, S>::value, "Construction is impossible");
@@ -131,12 +244,19 @@ namespace triqs {
       }
 
       struct _cdress;
-      many_body_operator_generic(_cdress const &term) { normalize_and_insert(term.monomial, term.coef, monomials); }
+      many_body_operator_generic(_cdress const &term) {
+        packed_monomial_t m;
+        for (auto const &c : term.monomial) m.push_back(&c);
+        packed_map_t tmp_map;
+        normalize_and_insert(std::move(m), term.coef, tmp_map);
+        add_packed_terms(tmp_map, monomials);
+      }
 
       template <typename S> many_body_operator_generic &operator=(many_body_operator_generic<S> const &x) {
         static_assert(std::is_constructible<scalar_t, S>::value, "Assignment is impossible");
         monomials.clear();
         for (auto const &y : x.get_monomials()) monomials.insert(std::make_pair(monomial_t{y.first}, scalar_t(y.second)));
+        _monomials_changed();
         return *this;
       }
 
@@ -146,8 +266,8 @@ namespace triqs {
       /// Make a minimal fundamental_operator_set with all the canonical operators of this
       hilbert_space::fundamental_operator_set make_fundamental_operator_set() const {
         hilbert_space::fundamental_operator_set fops;
-        for (auto const &m : monomials)         // for all monomials of the operator
-          for (auto const &c_cdag_op : m.first) // loop over the C C^+ operators of the monomial
+        for (auto const &m : *this)                // for all monomials of the operator, in order
+          for (auto const &c_cdag_op : m.monomial) // loop over the C C^+ operators of the monomial
             fops.insert_from_indices_t(c_cdag_op.indices);
         return fops;
       }
@@ -165,7 +285,7 @@ namespace triqs {
       struct _cdress {
         monomial_t const &monomial;
         scalar_t coef;
-        _cdress(typename monomials_map_t::const_iterator _it) : monomial(_it->first), coef(_it->second) {}
+        _cdress(typename sorted_terms_t::const_iterator _it) : monomial((*_it)->first), coef((*_it)->second) {}
         operator std::pair<std::vector<std::pair<bool, indices_t>>, scalar_t>() {
           std::vector<std::pair<bool, indices_t>> tmp_monomial;
           tmp_monomial.reserve(monomial.size());
@@ -173,14 +293,14 @@ namespace triqs {
           return {tmp_monomial, coef};
         }
       };
-      using const_iterator = utility::dressed_iterator<typename monomials_map_t::const_iterator, _cdress>;
+      using const_iterator = utility::dressed_iterator<typename sorted_terms_t::const_iterator, _cdress>;
 
       public:
-      // Iterators (only const!)
-      const_iterator begin() const noexcept { return monomials.begin(); }
-      const_iterator end() const noexcept { return monomials.end(); }
-      const_iterator cbegin() const noexcept { return monomials.cbegin(); }
-      const_iterator cend() const noexcept { return monomials.cend(); }
+      // Iterators (only const!), in the order of the monomials
+      const_iterator begin() const { return sorted_terms().cbegin(); }
+      const_iterator end() const { return sorted_terms().cend(); }
+      const_iterator cbegin() const { return sorted_terms().cbegin(); }
+      const_iterator cend() const { return sorted_terms().cend(); }
 
       /// Check if the operator is close to zero
       [[nodiscard]] bool is_almost_zero(double precision = 1e-10) const {
@@ -208,6 +328,7 @@ namespace triqs {
           it->second += alpha;
           erase_zero_monomial(monomials, it);
         }
+        _monomials_changed();
         return *this;
       }
 
@@ -220,6 +341,7 @@ namespace triqs {
         using triqs::utility::is_zero;
         if (is_zero(alpha)) {
           monomials.clear();
+          _monomials_changed();
         } else {
           for (auto &m : monomials) m.second *= alpha;
         }
@@ -239,6 +361,7 @@ namespace triqs {
             erase_zero_monomial(monomials, it);
           }
         }
+        _monomials_changed();
         return *this;
       }
 
@@ -252,23 +375,29 @@ namespace triqs {
             erase_zero_monomial(monomials, it);
           }
         }
+        _monomials_changed();
         return *this;
       }
 
       many_body_operator_generic &operator*=(many_body_operator_generic const &op) {
-        monomials_map_t tmp_map; // product will be stored here
+        // The products are accumulated in a hash map of pointers into the monomials of the factors,
+        // the normalized monomials are only materialized once, when moved into the result
+        packed_map_t packed_map;
+        packed_map.reserve(monomials.size() * op.monomials.size());
         for (auto const &m : monomials)
           for (auto const &op_m : op.monomials) {
             // prepare an unnormalized product
-            monomial_t product_m;
+            packed_monomial_t product_m;
             product_m.reserve(m.first.size() + op_m.first.size());
-            for (auto const &op : m.first) product_m.push_back(op);
-            for (auto const &op : op_m.first) product_m.push_back(op);
-            // std::copy(m.first.begin(), m.first.end(), std::back_inserter(product_m));
-            // std::copy(op_m.first.begin(), op_m.first.end(), std::back_inserter(product_m));
-            normalize_and_insert(product_m, m.second * op_m.second, tmp_map);
+            for (auto const &c : m.first) product_m.push_back(&c);
+            for (auto const &c : op_m.first) product_m.push_back(&c);
+            normalize_and_insert(std::move(product_m), m.second * op_m.second, packed_map);
           }
+        monomials_map_t tmp_map; // product will be stored here
+        tmp_map.reserve(packed_map.size());
+        add_packed_terms(packed_map, tmp_map);
         std::swap(monomials, tmp_map);
+        _monomials_changed();
         return *this;
       }
 
@@ -277,7 +406,11 @@ namespace triqs {
       // implementation details of dagger
       //
       private:
-      static canonical_ops_t _dagger(canonical_ops_t const &cop) { return {!cop.dagger, cop.indices}; }
+      static canonical_ops_t _dagger(canonical_ops_t const &cop) {
+        auto res   = cop; // keeps the interned indices
+        res.dagger = !cop.dagger;
+        return res;
+      }
 
       static monomial_t _dagger(monomial_t const &m) {
         monomial_t res;
@@ -339,11 +472,26 @@ namespace triqs {
 
       // Boost.Serialization
       friend class boost::serialization::access;
-      template <class Archive> void serialize(Archive &ar, const unsigned int version) { ar &monomials; }
+      // As plain data : the canonical operators are built again (and interned) when loading
+      template <class Archive> void serialize(Archive &ar, const unsigned int version) {
+        std::vector<std::pair<std::vector<std::pair<bool, indices_t>>, scalar_t>> terms;
+        if constexpr (!Archive::is_loading::value)
+          for (auto x : *this) terms.push_back(x);
+        ar &terms;
+        if constexpr (Archive::is_loading::value) {
+          monomials.clear();
+          for (auto const &[m, coef] : terms) {
+            monomial_t monomial;
+            for (auto const &[dagger, indices] : m) monomial.emplace_back(dagger, indices);
+            monomials.emplace(std::move(monomial), coef);
+          }
+          _monomials_changed();
+        }
+      }
 
       private:
       // Normalize a monomial and insert into a map
-      static void normalize_and_insert(monomial_t m, scalar_t coeff, monomials_map_t &target) {
+      static void normalize_and_insert(packed_monomial_t m, scalar_t coeff, packed_map_t &target) {
         // The normalization is done by employing a simple bubble sort algorithms.
         // Apart from sorting elements this function keeps track of the sign and
         // recursively calls itself if a permutation of two operators produces a new
@@ -353,20 +501,17 @@ namespace triqs {
           do {
             is_swapped = false;
             for (std::size_t n = 1; n < m.size(); ++n) {
-              canonical_ops_t &prev_index = m[n - 1];
-              canonical_ops_t &cur_index  = m[n];
-              if (prev_index == cur_index) return; // The monomial is effectively zero
-              if (prev_index > cur_index) {
+              canonical_ops_t const *&prev_index = m[n - 1];
+              canonical_ops_t const *&cur_index  = m[n];
+              if (*prev_index == *cur_index) return; // The monomial is effectively zero
+              if (*prev_index > *cur_index) {
                 // Are we swapping C and C^+ with the same indices?
-                // A bit ugly ...
-                canonical_ops_t cur_index_flipped_type(cur_index);
-                cur_index_flipped_type.dagger = !cur_index_flipped_type.dagger;
-                if (prev_index == cur_index_flipped_type) {
-                  monomial_t new_m;
+                if (prev_index->indices_id() == cur_index->indices_id()) {
+                  packed_monomial_t new_m;
                   new_m.reserve(m.size() - 2);
                   std::copy(m.begin(), m.begin() + n - 1, std::back_inserter(new_m));
                   std::copy(m.begin() + n + 1, m.end(), std::back_inserter(new_m));
-                  normalize_and_insert(new_m, coeff, target);
+                  normalize_and_insert(std::move(new_m), coeff, target);
                 }
                 coeff = -coeff;
                 std::swap(prev_index, cur_index);
@@ -378,11 +523,26 @@ namespace triqs {
 
         // Insert the result
         bool is_new_monomial;
+        typename packed_map_t::iterator it;
+        std::tie(it, is_new_monomial) = target.try_emplace(std::move(m), coeff);
+        if (!is_new_monomial) it->second += coeff;
+      }
+
+      // Add the non-vanishing terms of a packed map to a map of monomials
+      static void add_packed_terms(packed_map_t const &packed_map, monomials_map_t &target) {
+        using triqs::utility::is_zero;
+        bool is_new_monomial;
         typename monomials_map_t::iterator it;
-        std::tie(it, is_new_monomial) = target.insert(std::make_pair(std::move(m), coeff));
-        if (!is_new_monomial) {
-          it->second += coeff;
-          erase_zero_monomial(target, it);
+        for (auto const &[packed_m, coeff] : packed_map) {
+          if (is_zero(coeff)) continue;
+          monomial_t m;
+          m.reserve(packed_m.size());
+          for (auto const *c : packed_m) m.push_back(*c);
+          std::tie(it, is_new_monomial) = target.insert(std::make_pair(std::move(m), coeff));
+          if (!is_new_monomial) {
+            it->second += coeff;
+            erase_zero_monomial(target, it);
+          }
         }
       }
 
@@ -396,9 +556,9 @@ namespace triqs {
       friend std::ostream &operator<<(std::ostream &os, many_body_operator_generic const &op) {
         if (op.monomials.size() != 0) {
           bool print_plus = false;
-          for (auto const &m : op.monomials) {
-            os << (print_plus ? " + " : "") << m.second;
-            os << m.first;
+          for (auto const &m : op) {
+            os << (print_plus ? " + " : "") << m.coef;
+            os << m.monomial;
             print_plus = true;
           }
         } else
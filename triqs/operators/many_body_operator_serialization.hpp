@@ -21,3 +21,4 @@
 #pragma once
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/utility.hpp>
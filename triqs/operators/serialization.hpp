@@ -22,3 +22,4 @@
 #include <triqs/operators/many_body_operator.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/utility.hpp>
@@ -0,0 +1,288 @@
+/*******************************************************************************
+ *
+ * TRIQS: a Toolbox for Research in Interacting Quantum Systems
+ *
+ * Copyright (C) 2019, The Simons Foundation
+ *
+ * TRIQS is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * TRIQS is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * TRIQS. If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#pragma once
+#include "../arrays.hpp"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <triqs/utility/variant.hpp>
+#include <vector>
+
+namespace triqs {
+  namespace utility {
+
+    /*
+     * A compact binary archive, for the objects with a (boost compatible) serialize(Archive &, unsigned int) method.
+     *
+     * Format : the magic "TRQB", the version (uint32_t), then the numbers in the native byte order.
+     * It is meant to transfer objects between processes on the same kind of machines (mpi, multiprocessing),
+     * not for storage (use h5 for that).
+     *
+     * The elements of the arrays are copied with a single memcpy into the buffer, and out of it.
+     */
+    constexpr char binary_archive_magic[4]  = {'T', 'R', 'Q', 'B'};
+    constexpr uint32_t binary_archive_version = 1;
+
+    class binary_oarchive;
+    class binary_iarchive;
+
+    namespace detail {
+      // The types copied bit by bit
+      template <typename T> constexpr bool is_bitwise_v = std::is_arithmetic_v<T> or std::is_enum_v<T> or triqs::is_complex<T>::value;
+
+      template <typename T> void binary_save(binary_oarchive &ar, T const &x);
+      template <typename T> void binary_load(binary_iarchive &ar, T &x);
+    } // namespace detail
+
+    /// Writes into a std::vector<char>
+    class binary_oarchive {
+      std::vector<char> &_buf;
+
+      public:
+      using is_loading = std::false_type;
+      using is_saving  = std::true_type;
+
+      explicit binary_oarchive(std::vector<char> &buf) : _buf(buf) {
+        write_bytes(binary_archive_magic, 4);
+        write_bytes(&binary_archive_version, sizeof(uint32_t));
+      }
+
+      void write_bytes(void const *p, size_t n) {
+        auto q = static_cast<char const *>(p);
+        _buf.insert(_buf.end(), q, q + n);
+      }
+
+      template <typename T> binary_oarchive &operator&(T const &x) {
+        detail::binary_save(*this, x);
+        return *this;
+      }
+      template <typename T> binary_oarchive &operator<<(T const &x) { return operator&(x); }
+    };
+
+    /// Reads from a buffer, without copying it
+    class binary_iarchive {
+      char const *_p, *_end;
+
+      public:
+      using is_loading = std::true_type;
+      using is_saving  = std::false_type;
+
+      binary_iarchive(char const *data, size_t size) : _p(data), _end(data + size) {
+        char magic[4];
+        uint32_t version = 0;
+        read_bytes(magic, 4);
+        if (std::memcmp(magic, binary_archive_magic, 4) != 0) TRIQS_RUNTIME_ERROR << "binary_iarchive : this is not a binary archive of triqs";
+        read_bytes(&version, sizeof(uint32_t));
+        if (version != binary_archive_version)
+          TRIQS_RUNTIME_ERROR << "binary_iarchive : the archive has version " << version << ", I can only read version " << binary_archive_version;
+      }
+
+      void read_bytes(void *p, size_t n) {
+        if (n > size_t(_end - _p)) TRIQS_RUNTIME_ERROR << "binary_iarchive : unexpected end of the archive";
+        std::memcpy(p, _p, n);
+        _p += n;
+      }
+
+      template <typename T> binary_iarchive &operator&(T &x) {
+        detail::binary_load(*this, x);
+        return *this;
+      }
+      template <typename T> binary_iarchive &operator>>(T &x) { return operator&(x); }
+    };
+
+    namespace detail {
+
+      template <typename> struct is_std_vector : std::false_type {};
+      template <typename T, typename A> struct is_std_vector<std::vector<T, A>> : std::true_type {};
+      template <typename> struct is_std_map : std::false_type {};
+      template <typename K, typename V, typename C, typename A> struct is_std_map<std::map<K, V, C, A>> : std::true_type {};
+      template <typename> struct is_std_pair_or_tuple : std::false_type {};
+      template <typename A, typename B> struct is_std_pair_or_tuple<std::pair<A, B>> : std::true_type {};
+      template <typename... T> struct is_std_pair_or_tuple<std::tuple<T...>> : std::true_type {};
+      template <typename> struct is_std_optional : std::false_type {};
+      template <typename T> struct is_std_optional<std::optional<T>> : std::true_type {};
+      template <typename> struct is_std_variant : std::false_type {};
+      template <typename... T> struct is_std_variant<std::variant<T...>> : std::true_type { using types = std::tuple<T...>; };
+
+      // elements [p, p + n)
+      template <typename T> void binary_save_n(binary_oarchive &ar, T const *p, size_t n) {
+        if constexpr (is_bitwise_v<T>)
+          ar.write_bytes(p, n * sizeof(T));
+        else
+          for (size_t i = 0; i < n; ++i) binary_save(ar, p[i]);
+      }
+      template <typename T> void binary_load_n(binary_iarchive &ar, T *p, size_t n) {
+        if constexpr (is_bitwise_v<T>)
+          ar.read_bytes(p, n * sizeof(T));
+        else
+          for (size_t i = 0; i < n; ++i) binary_load(ar, p[i]);
+      }
+
+      template <typename V, size_t... Is> void binary_load_variant(binary_iarchive &ar, V &v, uint64_t idx, std::index_sequence<Is...>) {
+        auto load_alt = [&](auto I) {
+          std::tuple_element_t<decltype(I)::value, typename is_std_variant<V>::types> a{};
+          binary_load(ar, a);
+          v = std::move(a);
+        };
+        ((idx == Is ? load_alt(std::integral_constant<size_t, Is>{}) : void()), ...);
+      }
+
+      // ---------------- save ---------------------
+
+      template <typename T> void binary_save(binary_oarchive &ar, T const &x) {
+        if constexpr (is_bitwise_v<T>)
+          ar.write_bytes(&x, sizeof(T));
+        else if constexpr (std::is_array_v<T>)
+          binary_save_n(ar, &x[0], std::extent_v<T>);
+        else if constexpr (std::is_same_v<T, std::string>) {
+          binary_save(ar, uint64_t(x.size()));
+          ar.write_bytes(x.data(), x.size());
+        } else if constexpr (is_std_vector<T>::value) {
+          binary_save(ar, uint64_t(x.size()));
+          if constexpr (std::is_same_v<T, std::vector<bool>>)
+            for (bool b : x) binary_save(ar, b);
+          else
+            binary_save_n(ar, x.data(), x.size());
+        } else if constexpr (is_std_map<T>::value) {
+          binary_save(ar, uint64_t(x.size()));
+          for (auto const &[k, v] : x) {
+            binary_save(ar, k);
+            binary_save(ar, v);
+          }
+        } else if constexpr (is_std_pair_or_tuple<T>::value)
+          std::apply([&ar](auto const &... y) { (binary_save(ar, y), ...); }, x);
+        else if constexpr (is_std_optional<T>::value) {
+          binary_save(ar, bool(x));
+          if (x) binary_save(ar, *x);
+        } else if constexpr (is_std_variant<T>::value) {
+          binary_save(ar, uint64_t(x.index()));
+          visit([&ar](auto const &y) { binary_save(ar, y); }, x);
+        } else if constexpr (arrays::is_amv_value_or_view_class<T>::value) {
+          auto const &sh = x.shape();
+          for (int r = 0; r < T::rank; ++r) binary_save(ar, uint64_t(sh[r]));
+          if (x.indexmap().is_contiguous() and x.indexmap().memory_layout().is_c())
+            binary_save_n(ar, x.data_start(), x.size());
+          else { // in C order
+            arrays::array<typename T::value_type, T::rank> c(x, C_LAYOUT);
+            binary_save_n(ar, c.data_start(), c.size());
+          }
+        } else // the serialize method of the object, as for boost
+          boost::serialization::access::serialize(ar, const_cast<T &>(x), 0);
+      }
+
+      // ---------------- load ---------------------
+
+      template <typename T> void binary_load(binary_iarchive &ar, T &x) {
+        if constexpr (is_bitwise_v<T>)
+          ar.read_bytes(&x, sizeof(T));
+        else if constexpr (std::is_array_v<T>)
+          binary_load_n(ar, &x[0], std::extent_v<T>);
+        else if constexpr (std::is_same_v<T, std::string>) {
+          uint64_t n;
+          binary_load(ar, n);
+          x.resize(n);
+          ar.read_bytes(x.data(), n);
+        } else if constexpr (is_std_vector<T>::value) {
+          uint64_t n;
+          binary_load(ar, n);
+          x.resize(n);
+          if constexpr (std::is_same_v<T, std::vector<bool>>)
+            for (size_t i = 0; i < n; ++i) {
+              bool b;
+              binary_load(ar, b);
+              x[i] = b;
+            }
+          else
+            binary_load_n(ar, x.data(), n);
+        } else if constexpr (is_std_map<T>::value) {
+          uint64_t n;
+          binary_load(ar, n);
+          x.clear();
+          for (size_t i = 0; i < n; ++i) {
+            typename T::key_type k;
+            typename T::mapped_type v;
+            binary_load(ar, k);
+            binary_load(ar, v);
+            x.emplace_hint(x.end(), std::move(k), std::move(v));
+          }
+        } else if constexpr (is_std_pair_or_tuple<T>::value)
+          std::apply([&ar](auto &... y) { (binary_load(ar, y), ...); }, x);
+        else if constexpr (is_std_optional<T>::value) {
+          bool has_value;
+          binary_load(ar, has_value);
+          if (has_value) {
+            typename T::value_type v{};
+            binary_load(ar, v);
+            x = std::move(v);
+          } else
+            x.reset();
+        } else if constexpr (is_std_variant<T>::value) {
+          uint64_t idx;
+          binary_load(ar, idx);
+          constexpr size_t n_alt = std::tuple_size_v<typename is_std_variant<T>::types>;
+          if (idx >= n_alt) TRIQS_RUNTIME_ERROR << "binary_iarchive : invalid variant index " << idx;
+          binary_load_variant(ar, x, idx, std::make_index_sequence<n_alt>{});
+        } else if constexpr (arrays::is_amv_value_or_view_class<T>::value) {
+          arrays::mini_vector<size_t, T::rank> sh;
+          for (int r = 0; r < T::rank; ++r) {
+            uint64_t l;
+            binary_load(ar, l);
+            sh[r] = l;
+          }
+          if constexpr (arrays::is_amv_value_class<T>::value)
+            x.resize(sh);
+          else if (x.shape() != sh)
+            TRIQS_RUNTIME_ERROR << "binary_iarchive : can not load an array of shape " << sh << " into a view of shape " << x.shape();
+          if (x.indexmap().is_contiguous() and x.indexmap().memory_layout().is_c())
+            binary_load_n(ar, x.data_start(), x.size());
+          else {
+            arrays::array<typename T::value_type, T::rank> c(sh);
+            binary_load_n(ar, c.data_start(), c.size());
+            x() = c;
+          }
+        } else
+          boost::serialization::access::serialize(ar, x, 0);
+      }
+    } // namespace detail
+
+    /// Serialize x into a compact binary archive (cf binary_oarchive)
+    template <typename T> std::vector<char> binary_serialize(T const &x) {
+      std::vector<char> buf;
+      binary_oarchive ar{buf};
+      ar &x;
+      return buf;
+    }
+
+    /// Rebuild an object from the binary archive produced by binary_serialize
+    template <typename T> T binary_deserialize(char const *data, size_t size) {
+      binary_iarchive ar{data, size};
+      regular_t<T> res;
+      ar &res;
+      return res;
+    }
+
+    template <typename T> T binary_deserialize(std::vector<char> const &buf) { return binary_deserialize<T>(buf.data(), buf.size()); }
+
+  } // namespace utility
+} // namespace triqs
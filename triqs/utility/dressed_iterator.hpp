@@ -53,7 +53,8 @@ namespace triqs {
     template <typename IteratorType, typename Dressing, typename DressingAuxiliaryArgumentPtrType = void> struct dressed_iterator;
 
     namespace details {
-      template <typename IteratorType> constexpr bool is_bidir = std::is_same_v<typename IteratorType::iterator_category, std::bidirectional_iterator_tag>;
+      template <typename IteratorType>
+      constexpr bool is_bidir = std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<IteratorType>::iterator_category>;
     } // namespace details
 
     // specialization when a aux data is present
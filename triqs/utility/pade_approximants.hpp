@@ -27,6 +27,8 @@
 #include <triqs/utility/exceptions.hpp>
 #include <triqs/arrays.hpp>
 #include <gmpxx.h>
+#include <vector>
+#include <limits>
 
 namespace triqs {
   namespace utility {
@@ -67,47 +69,109 @@ namespace triqs {
 
       arrays::vector<dcomplex> z_in; // Input complex frequency points
       arrays::vector<dcomplex> a;    // Pade coefficients
+      bool multiprecision = true;    // Were the coefficients computed with GMP floats?
 
       public:
       static const int GMP_default_prec = 256; // Precision of GMP floats to use during a Pade coefficients calculation.
 
-      pade_approximant(const arrays::vector<dcomplex> &z_in_, const arrays::vector<dcomplex> &u_in) : z_in(z_in_), a(z_in.size()) {
+      /// Largest relative error on the coefficients accepted from the long double calculation in adaptive mode
+      static constexpr double adaptive_tolerance = 1e-12;
+
+      /**
+       * @param z_in_ Input complex frequency points
+       * @param u_in Values at these points
+       * @param adaptive_precision If true, first compute the coefficients in long double arithmetic,
+       *        and only resort to GMP floats if the estimated relative error on them exceeds adaptive_tolerance.
+       */
+      pade_approximant(const arrays::vector<dcomplex> &z_in_, const arrays::vector<dcomplex> &u_in, bool adaptive_precision = false)
+         : z_in(z_in_), a(z_in.size()) {
+        if (adaptive_precision && compute_coefficients_long_double(u_in)) {
+          multiprecision = false;
+          return;
+        }
+        compute_coefficients_gmp(u_in);
+      }
+
+      /// Were the coefficients computed with GMP floats ?
+      bool uses_multiprecision() const { return multiprecision; }
+
+      private:
+      // The coefficients are the diagonal a(p) = g(p,p) of the table
+      //   g(0,j) = u_j,  g(p,j) = (g(p-1,p-1) / g(p-1,j) - 1) / (z_j - z_{p-1})
+      // which is computed row by row, in place (row p only depends on row p-1).
+
+      void compute_coefficients_gmp(const arrays::vector<dcomplex> &u_in) {
 
         int N = z_in.size();
 
-        // Change the default precision of GMP floats.
-        unsigned long old_prec = mpf_get_default_prec();
-        mpf_set_default_prec(GMP_default_prec); // How do we determine it?
+        // Precision is set on each float explicitly: the GMP default precision is a global
+        // and must not be changed if several approximants are constructed concurrently.
+        auto make = [](dcomplex x) { return gmp_complex{mpf_class(real(x), GMP_default_prec), mpf_class(imag(x), GMP_default_prec)}; };
 
-        arrays::array<gmp_complex, 2> g(N, N);
-        gmp_complex MP_0 = {0.0, 0.0};
-        g()              = MP_0;
-        for (int f = 0; f < N; ++f) { g(0, f) = u_in(f); };
+        std::vector<gmp_complex> g;
+        g.reserve(N);
+        for (int f = 0; f < N; ++f) g.push_back(make(u_in(f)));
 
-        gmp_complex MP_1 = {1.0, 0.0};
+        gmp_complex MP_1 = make(1.0);
 
-        for (int p = 1; p < N; ++p) {
+        int p = 1;
+        for (; p < N; ++p) {
 
           // If |g| is very small, the continued fraction should be truncated.
-          if (g(p - 1, p - 1).norm() < 1.0e-20) break;
+          if (g[p - 1].norm() < 1.0e-20) break;
 
           for (int j = p; j < N; ++j) {
-            gmp_complex x = g(p - 1, p - 1) / g(p - 1, j) - MP_1;
-            gmp_complex y;
-            y       = z_in(j) - z_in(p - 1);
-            g(p, j) = x / y;
+            gmp_complex x = g[p - 1] / g[j] - MP_1;
+            gmp_complex y = make(z_in(j) - z_in(p - 1));
+            g[j]          = x / y;
           }
         }
 
-        for (int j = 0; j < N; ++j) {
-          gmp_complex gj = g(j, j);
-          a(j)           = dcomplex(real(gj).get_d(), imag(gj).get_d());
+        for (int j = 0; j < N; ++j) a(j) = (j < p ? dcomplex(real(g[j]).get_d(), imag(g[j]).get_d()) : 0);
+      }
+
+      // Same recursion in long double, with a running estimate of the relative error on each entry.
+      // Returns false if the estimate on a coefficient exceeds adaptive_tolerance.
+      bool compute_coefficients_long_double(const arrays::vector<dcomplex> &u_in) {
+
+        using ldcomplex = std::complex<long double>;
+        long double const eps = std::numeric_limits<long double>::epsilon();
+
+        int N = z_in.size();
+        std::vector<ldcomplex> g(N);
+        std::vector<long double> err(N, eps);
+        for (int f = 0; f < N; ++f) g[f] = ldcomplex(u_in(f));
+
+        int p = 1;
+        for (; p < N; ++p) {
+
+          // Truncation: in exact arithmetic this coefficient vanishes, and the rounding noise it
+          // carries here would be meaningless
+          if (std::norm(g[p - 1]) < 1.0e-20) {
+            g[p - 1] = 0;
+            err[p - 1] = 0;
+            break;
+          }
+          if (err[p - 1] > adaptive_tolerance) return false;
+
+          for (int j = p; j < N; ++j) {
+            if (g[j] == ldcomplex(0)) return false;
+            ldcomplex r = g[p - 1] / g[j];
+            ldcomplex x = r - ldcomplex(1);
+            if (x == ldcomplex(0)) return false;
+            // The subtraction amplifies the relative error of r by |r| / |r - 1|
+            err[j] = (err[p - 1] + err[j] + 2 * eps) * std::abs(r) / std::abs(x) + 2 * eps;
+            g[j]   = x / ldcomplex(z_in(j) - z_in(p - 1));
+          }
         }
+        for (int j = 0; j < p; ++j)
+          if (err[j] > adaptive_tolerance) return false;
 
-        // Restore the precision.
-        mpf_set_default_prec(old_prec);
+        for (int j = 0; j < N; ++j) a(j) = (j < p ? dcomplex(g[j]) : 0);
+        return true;
       }
 
+      public:
       // give the value of the pade continued fraction at complex number e
       dcomplex operator()(dcomplex e) const {
 
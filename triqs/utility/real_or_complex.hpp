@@ -83,6 +83,8 @@ namespace triqs {
       bool operator==(real_or_complex const &x) const { return abs(_x - x._x) == 0; }
       bool operator!=(real_or_complex const &x) const { return !operator==(x); }
 
+      template <class Archive> void serialize(Archive &ar, const unsigned int version) { ar &_is_real &_x; }
+
 #define MAKE_OP(OP)                                                                                                                                  \
   inline real_or_complex &operator OP(double y) {                                                                                                    \
     _x OP y;                                                                                                                                         \
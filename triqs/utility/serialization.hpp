@@ -21,16 +21,27 @@
 #pragma once
 #include <triqs/h5.hpp>
 
-#if defined(TRIQS_SERIALIZATION_DO_NOT_USE_HDF5) or not H5_VERSION_GE(1, 8, 9)
+// By default, the compact binary archive (std::vector<char>).
+// The (slower) in-memory hdf5 file image (arrays::array<h5::h5_serialization_char_t, 1>) with TRIQS_SERIALIZATION_USE_HDF5,
+// the boost text archive (std::string) with TRIQS_SERIALIZATION_DO_NOT_USE_HDF5, as before.
+#if defined(TRIQS_SERIALIZATION_DO_NOT_USE_HDF5) or (defined(TRIQS_SERIALIZATION_USE_HDF5) and not H5_VERSION_GE(1, 8, 9))
 
 #define TRIQS_SERIALIZATION_WITH_HDF5_IMPOSSIBLE
 #include "./boost_serialization.hpp"
 
-#else
+#elif defined(TRIQS_SERIALIZATION_USE_HDF5)
 
 #include "../h5/serialization.hpp"
 namespace triqs {
   using h5::deserialize;
   using h5::serialize;
 } // namespace triqs
+
+#else
+
+#include "./binary_serialization.hpp"
+namespace triqs {
+  template <typename T> std::vector<char> serialize(T const &x) { return utility::binary_serialize(x); }
+  template <typename T> T deserialize(std::vector<char> const &buf) { return utility::binary_deserialize<T>(buf); }
+} // namespace triqs
 #endif